@@ -0,0 +1,415 @@
+// bench.cpp - A micro-benchmark of the building blocks of the sorting
+// algorithms: partitioning, merging, sifting down, gapped insertion sorting,
+// and median-of-three selection, each timed alone at chosen sizes.
+//
+// Written in 2018, 2019 by Eliah Kagan <degeneracypressure@gmail.com>.
+//
+// To the extent possible under law, the author(s) have dedicated all copyright
+// and related and neighboring rights to this software to the public domain
+// worldwide. This software is distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along
+// with this software. If not, see
+// <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "counters.h"
+#include "options.h"
+#include "sorts.h"
+
+namespace {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) \
+        || defined(__i386__)
+    constexpr auto have_tsc = true;
+
+    // Reads the time-stamp counter, which ticks at a fixed reference rate
+    // rather than at the core's current clock rate.
+    std::uint64_t read_tsc() noexcept { return __rdtsc(); }
+#else
+    constexpr auto have_tsc = false;
+
+    std::uint64_t read_tsc() noexcept { return 0; }
+#endif
+
+    // Where cycle counts come from. The perf counter counts the core's own
+    // cycles; the time-stamp counter is the fallback where perf is
+    // unavailable, and is only as accurate as the core's clock is steady.
+    enum class CycleSource { perf, tsc, none };
+
+    constexpr std::string_view cycle_source_name(const CycleSource source)
+    {
+        switch (source) {
+        case CycleSource::perf:
+            return "perf cycles counter"sv;
+        case CycleSource::tsc:
+            return "time-stamp counter (reference cycles)"sv;
+        case CycleSource::none:
+            return "unavailable"sv;
+        }
+
+        return ""sv;
+    }
+
+    // The mean time and cycles of one call of a kernel, over some calls. The
+    // cycles are averaged over only the calls they were counted for.
+    struct Cost {
+        double ns;
+        std::optional<double> cycles;
+        std::size_t calls;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // The fewest elements that calls timed together should cover, so that
+    // the fixed cost of reading the clocks and counters around them is
+    // spread thin. It is small enough that a batch of ints fits in L1.
+    constexpr std::size_t batch_elements {1 << 12};
+
+    // The smallest size accepted. Below it, the loop that calls a kernel
+    // costs too much, next to the kernel, to be spread thin.
+    constexpr std::size_t min_size {16};
+
+    // Calls a kernel on fresh copies of an input, made outside the timed
+    // region, until the timed calls add up to at least min_time. Calls are
+    // timed in batches covering batch_elements or more elements, each call
+    // on its own copy. At least one batch is timed, even if min_time is zero.
+    template<typename T, typename Kernel>
+    Cost measure(const std::vector<T>& input, const Kernel kernel,
+                 const Clock::duration min_time,
+                 counters::PerfCounters& perf, const CycleSource source)
+    {
+        const auto batch_size = std::max(batch_elements / size(input),
+                                         std::size_t{1});
+        std::vector<std::vector<T>> batch (batch_size, input);
+        kernel(batch.front()); // warm up
+
+        Clock::duration total {};
+        auto cycles = 0.0;
+        std::size_t calls {}, counted_calls {};
+
+        do {
+            for (auto& work : batch) work = input;
+
+            if (source == CycleSource::perf) perf.start();
+            const auto tsc_start = read_tsc();
+            const auto start = Clock::now();
+            for (auto& work : batch) kernel(work);
+            const auto stop = Clock::now();
+            const auto tsc_stop = read_tsc();
+
+            total += stop - start;
+            if (source == CycleSource::perf) {
+                if (const auto count = perf.stop()[counters::cycles]) {
+                    cycles += *count;
+                    counted_calls += batch_size;
+                }
+            } else {
+                cycles += static_cast<double>(tsc_stop - tsc_start);
+                counted_calls += batch_size;
+            }
+
+            calls += batch_size;
+        } while (total < min_time);
+
+        const auto n = static_cast<double>(calls);
+        const std::chrono::duration<double, std::nano> ns {total};
+
+        std::optional<double> mean_cycles;
+        if (source != CycleSource::none && counted_calls != 0)
+            mean_cycles = cycles / static_cast<double>(counted_calls);
+
+        return {ns.count() / n, mean_cycles, calls};
+    }
+
+    void print_cost(const std::string_view kernel, const Cost& cost,
+                    const std::size_t len)
+    {
+        const auto n = static_cast<double>(len);
+
+        std::cout << "    " << std::left << std::setw(40) << kernel
+                  << std::right << std::setw(9) << cost.ns / n << " ns/elem";
+
+        if (cost.cycles)
+            std::cout << std::setw(9) << *cost.cycles / n << " cycles/elem";
+
+        std::cout << "  (" << cost.calls << " calls)\n";
+    }
+
+    // Keeps the medians median_of_three finds from being optimized away.
+    volatile std::ptrdiff_t median_sink;
+
+    struct Options {
+        std::optional<std::uint64_t> seed; // random if absent
+        std::vector<std::size_t> sizes {1'000, 100'000, 1'000'000};
+        std::vector<std::string_view> types {"int"sv};
+        const Distribution* distribution {&all_distributions.front()};
+        Clock::duration min_time {std::chrono::milliseconds{100}};
+        bool help {false};
+    };
+
+    // Times each kernel on len elements of type E, made from keys of the
+    // chosen distribution. Kernels that consume a prepared input (such as
+    // sorted halves to merge) get it in the state the algorithms leave it in.
+    template<typename E>
+    void run_kernels(const Options& opts, const std::uint64_t seed,
+                     const std::size_t len, counters::PerfCounters& perf,
+                     const CycleSource source)
+    {
+        using T = typename E::Type;
+        using It = typename std::vector<T>::iterator;
+        using detail::Delta;
+
+        const auto run = [&](const std::string_view name,
+                             const std::vector<T>& input, const auto kernel) {
+            print_cost(name, measure(input, kernel, opts.min_time, perf,
+                                     source), len);
+        };
+
+        const auto& dist = *opts.distribution;
+        std::cout << len << "-element " << dist.name << ' ' << E::name
+                  << " vector:\n";
+
+        auto eng = distributions::make_engine(seed, dist.name, len);
+        const auto elems = make_elements<E>(dist.generate(len, eng));
+        const auto n = static_cast<Delta<It>>(len);
+
+        auto pivoted = elems;
+        detail::bring_median_of_three_to_front(begin(pivoted), end(pivoted));
+
+        run("partitions::lomuto"sv, pivoted, [](std::vector<T>& v) {
+            detail::partitions::lomuto(begin(v), end(v));
+        });
+
+        run("partitions::hoare"sv, pivoted, [](std::vector<T>& v) {
+            detail::partitions::hoare(begin(v), end(v));
+        });
+
+        auto halves = elems;
+        std::sort(begin(halves), begin(halves) + n / 2);
+        std::sort(begin(halves) + n / 2, end(halves));
+        auto aux = detail::make_aux<It>(n);
+
+        run("merge"sv, halves, [&aux, n](std::vector<T>& v) {
+            detail::merge(aux, begin(v), begin(v) + n / 2, end(v));
+        });
+
+        const auto heapify = [n](std::vector<T>& v) {
+            for (auto parent = n / 2; parent >= 0; --parent)
+                detail::sift_down(begin(v), n, parent);
+        };
+
+        run("sift_down (heapifying)"sv, elems, heapify);
+
+        auto heap = elems;
+        heapify(heap);
+
+        run("sift_down (popping)"sv, heap, [n](std::vector<T>& v) {
+            for (auto heap_len = n; --heap_len != 0; ) {
+                std::iter_swap(begin(v), begin(v) + heap_len);
+                detail::sift_down(begin(v), heap_len, 0);
+            }
+        });
+
+        // Each gap's pass gets the input as shellsort would give it, after
+        // the passes for all the larger gaps.
+        std::vector<Delta<It>> gaps;
+        detail::gaps::quasi_ciura(n, std::back_inserter(gaps));
+        auto shelled = elems;
+
+        std::for_each(crbegin(gaps), crend(gaps), [&](const Delta<It> gap) {
+            const auto pass = [gap](std::vector<T>& v) {
+                for (auto start = begin(v); start != begin(v) + gap; ++start)
+                    detail::insertion_sort_subsequence(start, end(v), gap);
+            };
+
+            run("insertion_sort_subsequence, gap " + std::to_string(gap),
+                shelled, pass);
+            pass(shelled);
+        });
+
+        run("median_of_three"sv, elems, [n](const std::vector<T>& v) {
+            std::ptrdiff_t sum {};
+            for (auto p = cbegin(v); p + 2 < cbegin(v) + n; p += 3)
+                sum += detail::median_of_three(p, p + 1, p + 2) - p;
+            median_sink = sum;
+        });
+
+        std::cout << '\n';
+    }
+
+    void print_usage(const std::string_view program)
+    {
+        std::cout << "Usage: " << program << " [OPTION]...\n"
+R"(Time the sorting algorithms' building blocks alone, per element.
+
+  -s, --size LIST       comma-separated sizes, at least 16 (with optional k,
+                        M, G suffix) and ranges FIRST..LAST[:xFACTOR|:+STEP]
+                        (default: 1k,100k,1M)
+  -t, --type LIST       comma-separated element types (default: int)
+  -d, --dist NAME       the distribution of the inputs (default: random)
+      --seed N          generate inputs from seed N (default: random); each
+                        input is the one Sorts makes with the same seed
+      --min-time MS     time each kernel for at least MS milliseconds of
+                        calls (default: 100)
+  -h, --help            show this help
+
+Values may follow their options as separate arguments or, for long options,
+after an equals sign. Run Sorts --list for the types and distributions.
+)";
+    }
+
+    bool is_type_name(const std::string_view name)
+    {
+        auto found = false;
+        for_each_element_type([name, &found](const auto e) {
+            if (decltype(e)::name == name) found = true;
+        });
+        return found;
+    }
+
+    // Parses options, which are spelled as Sorts spells the same options.
+    std::optional<Options> parse_options(const int argc,
+                                         const char* const* const argv)
+    {
+        Options opts;
+
+        for (auto i = 1; i < argc; ++i) {
+            std::string_view arg {argv[i]};
+            std::optional<std::string_view> attached;
+
+            if (const auto eq = arg.find('=');
+                    arg.substr(0, 2) == "--"sv
+                            && eq != std::string_view::npos) {
+                attached = arg.substr(eq + 1);
+                arg = arg.substr(0, eq);
+            }
+
+            const auto is = [arg](const std::string_view short_name,
+                                  const std::string_view long_name) {
+                return (!empty(short_name) && arg == short_name)
+                        || arg == long_name;
+            };
+
+            const auto takes_value = is("-s", "--size") || is("-t", "--type")
+                    || is("-d", "--dist") || is("", "--seed")
+                    || is("", "--min-time");
+
+            auto value = ""sv;
+            if (takes_value) {
+                if (attached) {
+                    value = *attached;
+                } else if (i + 1 < argc) {
+                    value = argv[++i];
+                } else {
+                    std::cerr << "error: " << arg << " needs a value\n";
+                    return std::nullopt;
+                }
+            } else if (attached) {
+                std::cerr << "error: " << arg << " takes no value\n";
+                return std::nullopt;
+            }
+
+            const auto bad_value = [arg, value] {
+                std::cerr << "error: bad value for " << arg << ": \""
+                          << value << "\"\n";
+                return std::nullopt;
+            };
+
+            if (is("-h", "--help")) {
+                opts.help = true;
+            } else if (is("-s", "--size")) {
+                auto sizes = parse_sizes(value);
+                if (!sizes || std::any_of(cbegin(*sizes), cend(*sizes),
+                                          [](const std::size_t len) {
+                                              return len < min_size;
+                                          }))
+                    return bad_value();
+                opts.sizes = std::move(*sizes);
+            } else if (is("-t", "--type")) {
+                opts.types = split(value);
+                if (!std::all_of(cbegin(opts.types), cend(opts.types),
+                                 is_type_name))
+                    return bad_value();
+            } else if (is("-d", "--dist")) {
+                const auto dist = std::find_if(cbegin(all_distributions),
+                                               cend(all_distributions),
+                                               [value](const auto& d) {
+                    return d.name == value && d.generate;
+                });
+                if (dist == cend(all_distributions)) return bad_value();
+                opts.distribution = &*dist;
+            } else if (is("", "--seed")) {
+                opts.seed = parse_number<std::uint64_t>(value);
+                if (!opts.seed) return bad_value();
+            } else if (is("", "--min-time")) {
+                const auto ms = parse_number<unsigned>(value);
+                if (!ms) return bad_value();
+                opts.min_time = std::chrono::milliseconds{*ms};
+            } else {
+                std::cerr << "error: unknown option " << arg
+                          << " (see --help)\n";
+                return std::nullopt;
+            }
+        }
+
+        return opts;
+    }
+}
+
+int main(const int argc, char* const* const argv)
+{
+    const auto opts = parse_options(argc, argv);
+    if (!opts) return EXIT_FAILURE;
+
+    if (opts->help) {
+        print_usage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+
+    const auto seed = opts->seed.value_or([] {
+        std::random_device rd;
+        return std::uint64_t{rd()} << 32 | rd();
+    }());
+
+    // Only cycles are counted, so the one counter needn't be multiplexed.
+    counters::PerfCounters perf {counters::EventMask{1} << counters::cycles};
+    auto source = CycleSource::none;
+    if (perf.available(counters::cycles))
+        source = CycleSource::perf;
+    else if (have_tsc)
+        source = CycleSource::tsc;
+
+    std::cout << "Seed: " << seed << " (pass --seed=" << seed
+              << " to reproduce these inputs)\n"
+              << "Cycles: " << cycle_source_name(source) << "\n\n"
+              << std::setprecision(3);
+
+    for (const auto len : opts->sizes) {
+        for (const auto type : opts->types) {
+            for_each_element_type([&](const auto e) {
+                using E = decltype(e);
+                if (E::name == type)
+                    run_kernels<E>(*opts, seed, len, perf, source);
+            });
+        }
+    }
+}
@@ -0,0 +1,182 @@
+// counters.h - Hardware and software event counts for the benchmarks, from
+// Linux's perf_event_open where it is available.
+//
+// Written in 2018, 2019 by Eliah Kagan <degeneracypressure@gmail.com>.
+//
+// To the extent possible under law, the author(s) have dedicated all copyright
+// and related and neighboring rights to this software to the public domain
+// worldwide. This software is distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along
+// with this software. If not, see
+// <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef SORTS_COUNTERS_H
+#define SORTS_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using namespace std::string_view_literals;
+
+    namespace counters {
+        // Hardware and software events that can be counted during each run.
+        enum Event : std::size_t {
+            cycles,
+            instructions,
+            branch_misses,
+            l1d_misses,
+            llc_misses,
+            dtlb_misses,
+            page_faults,
+            event_count,
+        };
+
+        constexpr std::array<std::string_view, event_count> event_names {
+            "cycles"sv, "instructions"sv, "branch_misses"sv, "l1d_misses"sv,
+            "llc_misses"sv, "dtlb_misses"sv, "page_faults"sv,
+        };
+
+        // Counts of events in one run, absent if they couldn't be counted.
+        using Sample = std::array<std::optional<double>, event_count>;
+
+        // A set of events, as a mask with bit 1 << event set for each.
+        using EventMask = std::uint32_t;
+
+        constexpr EventMask all_events {(EventMask{1} << event_count) - 1};
+
+        // Counts events in the calling thread, in user mode, with Linux's
+        // perf_event_open. Events it can't open (on other systems, all of
+        // them), or that aren't in the mask, are left uncounted. Opening
+        // fewer events makes it less likely that the kernel must multiplex
+        // them, which scales counts up from partial running times.
+        class PerfCounters {
+        public:
+            explicit PerfCounters(EventMask mask = all_events);
+
+            PerfCounters(const PerfCounters&) = delete;
+            PerfCounters& operator=(const PerfCounters&) = delete;
+
+            ~PerfCounters();
+
+            // Whether the event could be opened.
+            bool available(const Event event) const noexcept
+            {
+                return fds_[event] != -1;
+            }
+
+            // Resets and starts all counters.
+            void start() noexcept;
+
+            // Stops all counters, and reads them.
+            Sample stop() noexcept;
+
+        private:
+            std::array<int, event_count> fds_;
+        };
+
+#ifdef __linux__
+        PerfCounters::PerfCounters(const EventMask mask)
+        {
+            constexpr auto cache_read_miss = [](const std::uint64_t cache) {
+                return cache | PERF_COUNT_HW_CACHE_OP_READ << 8
+                             | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+            };
+
+            constexpr std::array<std::tuple<std::uint32_t, std::uint64_t>,
+                                 event_count> specs {{
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+                {PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_L1D)},
+                {PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_LL)},
+                {PERF_TYPE_HW_CACHE, cache_read_miss(PERF_COUNT_HW_CACHE_DTLB)},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+            }};
+
+            for (std::size_t i = 0; i != event_count; ++i) {
+                if (!(mask & EventMask{1} << i)) {
+                    fds_[i] = -1;
+                    continue;
+                }
+
+                perf_event_attr attr {};
+                attr.size = sizeof attr;
+                std::tie(attr.type, attr.config) = specs[i];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+                                 | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                // Counters are opened separately, not as a group, so the
+                // kernel can multiplex them if there are too few registers.
+                fds_[i] = static_cast<int>(
+                        syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            }
+        }
+
+        PerfCounters::~PerfCounters()
+        {
+            for (const auto fd : fds_)
+                if (fd != -1) close(fd);
+        }
+
+        void PerfCounters::start() noexcept
+        {
+            for (const auto fd : fds_) {
+                if (fd == -1) continue;
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+
+        Sample PerfCounters::stop() noexcept
+        {
+            for (const auto fd : fds_)
+                if (fd != -1) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            Sample sample;
+
+            for (std::size_t i = 0; i != event_count; ++i) {
+                if (fds_[i] == -1) continue;
+
+                // The count, time enabled, and time running.
+                std::array<std::uint64_t, 3> values {};
+                const auto len = read(fds_[i], data(values), sizeof values);
+
+                // Scale up the count if the counter was multiplexed.
+                if (len == sizeof values && values[2] != 0) {
+                    sample[i] = static_cast<double>(values[0])
+                                * static_cast<double>(values[1])
+                                / static_cast<double>(values[2]);
+                }
+            }
+
+            return sample;
+        }
+#else
+        PerfCounters::PerfCounters(EventMask) { fds_.fill(-1); }
+
+        PerfCounters::~PerfCounters() = default;
+
+        void PerfCounters::start() noexcept { }
+
+        Sample PerfCounters::stop() noexcept { return {}; }
+#endif
+    }
+}
+
+#endif // !SORTS_COUNTERS_H
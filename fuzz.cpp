@@ -0,0 +1,319 @@
+// fuzz.cpp - A differential test of the sorting algorithms, which checks each
+// against the standard library and shrinks any input it gets wrong.
+//
+// Built with SORTS_LIBFUZZER defined (as cmake does with clang), this is a
+// libFuzzer target. Otherwise it is a driver that runs random cases, of random
+// sizes, element types, and distributions, from a seed.
+//
+// Written in 2018, 2019 by Eliah Kagan <degeneracypressure@gmail.com>.
+//
+// To the extent possible under law, the author(s) have dedicated all copyright
+// and related and neighboring rights to this software to the public domain
+// worldwide. This software is distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along
+// with this software. If not, see
+// <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "sorts.h"
+
+namespace {
+    // Whether two sequences hold equivalent elements in the same order.
+    template<typename T>
+    bool equivalent(const std::vector<T>& lhs, const std::vector<T>& rhs)
+    {
+        return std::equal(cbegin(lhs), cend(lhs), cbegin(rhs), cend(rhs),
+                          [](const T& x, const T& y) {
+                              return !(x < y) && !(y < x);
+                          });
+    }
+
+    // What, if anything, the algorithm at index i gets wrong on elements of
+    // type E made from keys. Its output must match std::sort's and, if it is
+    // stable, must keep equal elements in the order std::stable_sort does.
+    template<typename E>
+    std::optional<std::string_view> check(const std::size_t i,
+                                          const std::vector<int>& keys)
+    {
+        using T = typename E::Type;
+
+        const auto& algorithm = algorithms<T>()[i];
+        assert(algorithm.sort);
+
+        const auto input = make_elements<E>(keys);
+
+        auto expected = input;
+        std::sort(begin(expected), end(expected));
+        auto actual = input;
+        algorithm.sort(data(actual), data(actual) + size(actual));
+        if (!equivalent(actual, expected)) return "misordered"sv;
+
+        if (!algorithm.stable) return std::nullopt;
+
+        std::vector<Indexed<T>> indexed;
+        indexed.reserve(size(input));
+        for (const auto& elem : input)
+            indexed.push_back({elem, size(indexed)});
+
+        auto expected_indexed = indexed;
+        std::stable_sort(begin(expected_indexed), end(expected_indexed));
+        algorithms<Indexed<T>>()[i].sort(data(indexed),
+                                         data(indexed) + size(indexed));
+
+        const auto same_index = [](const Indexed<T>& x, const Indexed<T>& y) {
+            return x.index == y.index;
+        };
+        if (!std::equal(cbegin(indexed), cend(indexed),
+                        cbegin(expected_indexed), cend(expected_indexed),
+                        same_index))
+            return "unstable"sv;
+
+        return std::nullopt;
+    }
+
+    // Shrinks keys on which the algorithm at index i fails to fewer and
+    // smaller keys on which it still fails, first by removing ever shorter
+    // runs of them, then by moving each toward zero, until neither helps.
+    template<typename E>
+    std::vector<int> shrink(const std::size_t i, std::vector<int> keys)
+    {
+        const auto fails = [i](const std::vector<int>& candidate) {
+            return check<E>(i, candidate).has_value();
+        };
+
+        for (auto progress = true; progress; ) {
+            progress = false;
+
+            for (auto run = size(keys) / 2; run != 0; run /= 2) {
+                for (std::size_t pos = 0; pos + run <= size(keys); ) {
+                    auto candidate = keys;
+                    const auto first = begin(candidate)
+                                        + static_cast<std::ptrdiff_t>(pos);
+                    candidate.erase(first,
+                                    first + static_cast<std::ptrdiff_t>(run));
+
+                    if (fails(candidate)) {
+                        keys = std::move(candidate);
+                        progress = true;
+                    } else {
+                        pos += run;
+                    }
+                }
+            }
+
+            // Renumbers the keys 0, 1, 2, ... in order, which keeps their ties.
+            auto distinct = keys;
+            std::sort(begin(distinct), end(distinct));
+            distinct.erase(std::unique(begin(distinct), end(distinct)),
+                           end(distinct));
+            auto ranked = keys;
+            for (auto& key : ranked) {
+                key = static_cast<int>(std::lower_bound(cbegin(distinct),
+                                                        cend(distinct), key)
+                                       - cbegin(distinct));
+            }
+            if (ranked != keys && fails(ranked)) {
+                keys = std::move(ranked);
+                progress = true;
+            }
+
+            // Sets a key to zero, or else to half itself, if it still fails.
+            const auto lower = [&keys, &fails](int& key) {
+                const auto old = key;
+                for (const auto candidate : {0, old / 2}) {
+                    key = candidate;
+                    if (fails(keys)) return true;
+                }
+                key = old;
+                return false;
+            };
+
+            for (auto& key : keys)
+                while (key != 0 && lower(key)) progress = true;
+        }
+
+        return keys;
+    }
+
+    // Prints what the algorithm at index i gets wrong on keys, and the keys.
+    template<typename E>
+    void report(const std::size_t i, const std::vector<int>& keys)
+    {
+        const auto& algorithm = algorithms<typename E::Type>()[i];
+        const auto what = check<E>(i, keys);
+        assert(what);
+
+        std::cerr << algorithm.name << " gave " << *what << " output for "
+                  << size(keys) << ' ' << E::name << " elements, from keys [";
+
+        auto sep = "";
+        for (const auto key : keys) {
+            std::cerr << sep << key;
+            sep = ", ";
+        }
+
+        std::cerr << "]\n";
+    }
+
+    // Runs each algorithm that can sort elements of type E on keys. If any
+    // gets it wrong, reports the first with a shrunk reproducer.
+    template<typename E>
+    bool passes(const std::vector<int>& keys)
+    {
+        const auto& algos = algorithms<typename E::Type>();
+
+        for (std::size_t i = 0; i != size(algos); ++i) {
+            if (algos[i].sort && check<E>(i, keys)) {
+                report<E>(i, shrink<E>(i, keys));
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    constexpr auto type_count = std::tuple_size_v<AllElementTypes>;
+
+    // Runs passes with the element type at index type_index.
+    bool passes(const std::size_t type_index, const std::vector<int>& keys)
+    {
+        assert(type_index < type_count);
+
+        auto result = true;
+        auto index = std::size_t{0};
+
+        for_each_element_type([&](const auto e) {
+            if (index++ == type_index) result = passes<decltype(e)>(keys);
+        });
+
+        return result;
+    }
+}
+
+#ifdef SORTS_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data,
+                                      std::size_t size);
+
+// Takes the first byte as the element type, and each later pair of bytes as a
+// key. The keys are only 16 bits wide, so that inputs often repeat them.
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* const data,
+                                      const std::size_t size)
+{
+    if (size == 0) return 0;
+
+    std::vector<int> keys;
+    keys.reserve(size / 2);
+    for (std::size_t k = 1; k + 1 < size; k += 2)
+        keys.push_back((data[k] | data[k + 1] << 8) - 0x8000);
+
+    if (!passes(data[0] % type_count, keys)) std::abort();
+    return 0;
+}
+#else
+namespace {
+    struct Options {
+        std::optional<std::uint64_t> seed; // random if absent
+        std::size_t iterations {1000};
+        std::size_t max_length {1000};
+    };
+
+    // Parses arguments of the form --name=value.
+    std::optional<Options> parse_options(const int argc, char* const* argv)
+    {
+        Options opts;
+
+        for (auto i = 1; i < argc; ++i) {
+            const std::string_view arg {argv[i]};
+            const auto eq = arg.find('=');
+            const auto name = arg.substr(0, eq);
+            const auto value = (eq == std::string_view::npos
+                                    ? ""sv : arg.substr(eq + 1));
+
+            std::uint64_t number {};
+            const auto last = value.data() + value.size();
+            const auto [p, ec] = std::from_chars(value.data(), last, number);
+            if (value.empty() || ec != std::errc{} || p != last) {
+                std::cerr << "error: expected --NAME=NUMBER, got " << arg
+                          << '\n';
+                return std::nullopt;
+            }
+
+            if (name == "--seed"sv) {
+                opts.seed = number;
+            } else if (name == "--iterations"sv) {
+                opts.iterations = static_cast<std::size_t>(number);
+            } else if (name == "--max-length"sv) {
+                opts.max_length = static_cast<std::size_t>(number);
+            } else {
+                std::cerr << "error: unknown option " << name << " (try "
+                          << "--seed, --iterations, or --max-length)\n";
+                return std::nullopt;
+            }
+        }
+
+        return opts;
+    }
+}
+
+int main(const int argc, char* const* const argv)
+{
+    const auto opts = parse_options(argc, argv);
+    if (!opts) return EXIT_FAILURE;
+
+    const auto seed = opts->seed.value_or([] {
+        std::random_device rd;
+        return std::uint64_t{rd()} << 32 | rd();
+    }());
+
+    std::cout << "Seed: " << seed << " (pass --seed=" << seed
+              << " to reproduce these cases)\n";
+
+    std::vector<Distribution> dists;
+    std::copy_if(cbegin(all_distributions), cend(all_distributions),
+                 std::back_inserter(dists),
+                 [](const Distribution& dist) { return dist.generate; });
+
+    // Short inputs are the likeliest to reach edge cases, so lengths are
+    // drawn from ranges of random power-of-two sizes.
+    auto max_bits = 0;
+    while ((std::size_t{1} << max_bits) < opts->max_length) ++max_bits;
+
+    std::mt19937_64 eng {seed};
+    using Pick = std::uniform_int_distribution<std::size_t>;
+
+    for (std::size_t n = 0; n != opts->iterations; ++n) {
+        const auto bits = std::uniform_int_distribution{0, max_bits}(eng);
+        const auto len = Pick{0, std::min(std::size_t{1} << bits,
+                                          opts->max_length)}(eng);
+        const auto& dist = dists[Pick{0, size(dists) - 1}(eng)];
+        const auto type_index = Pick{0, type_count - 1}(eng);
+
+        auto dist_eng = distributions::make_engine(eng(), dist.name, len);
+        if (!passes(type_index, dist.generate(len, dist_eng))) {
+            std::cerr << "(case " << n + 1 << ", from a " << dist.name
+                      << " input of length " << len << ")\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "All " << opts->iterations << " cases passed.\n";
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,34 @@
+# git_revision.cmake - writes the git revision of the source tree to a header
+#
+# This file is part of Sorts, a demo and limited benchmark of sorting
+# algorithms. The build runs it as a script, with SOURCE_DIR set to the source
+# tree and OUTPUT to the header to write.
+#
+# Written in 2018, 2019 by Eliah Kagan <degeneracypressure@gmail.com>.
+#
+# To the extent possible under law, the author(s) have dedicated all copyright
+# and related and neighboring rights to this software to the public domain
+# worldwide. This software is distributed without any warranty.
+#
+# You should have received a copy of the CC0 Public Domain Dedication along
+# with this software. If not, see
+# <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+execute_process(
+    COMMAND git describe --always --dirty
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE git_revision
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+
+set(content "#define SORTS_GIT_REVISION \"${git_revision}\"\n")
+
+# Leave the header alone if it is current, so nothing including it rebuilds.
+set(old_content "")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} old_content)
+endif()
+if(NOT content STREQUAL old_content)
+    file(WRITE ${OUTPUT} "${content}")
+endif()
@@ -0,0 +1,142 @@
+// options.h - Parsing of the lists and numbers given as values of the
+// benchmarks' command-line options.
+//
+// Written in 2018, 2019 by Eliah Kagan <degeneracypressure@gmail.com>.
+//
+// To the extent possible under law, the author(s) have dedicated all copyright
+// and related and neighboring rights to this software to the public domain
+// worldwide. This software is distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along
+// with this software. If not, see
+// <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef SORTS_OPTIONS_H
+#define SORTS_OPTIONS_H
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+    using namespace std::string_view_literals;
+
+    // Splits a comma-separated list.
+    std::vector<std::string_view> split(std::string_view list)
+    {
+        std::vector<std::string_view> items;
+
+        for (; ; ) {
+            const auto pos = list.find(',');
+            items.push_back(list.substr(0, pos));
+            if (pos == std::string_view::npos) return items;
+            list.remove_prefix(pos + 1);
+        }
+    }
+
+    // Parses the whole string as a number, if it is one.
+    template<typename T>
+    std::optional<T> parse_number(const std::string_view text)
+    {
+        T value {};
+        const auto last = text.data() + text.size();
+        const auto [p, ec] = std::from_chars(text.data(), last, value);
+        if (ec != std::errc{} || p != last) return std::nullopt;
+        return value;
+    }
+
+    // Parses a size, which may have a decimal suffix k, M, or G.
+    std::optional<std::size_t> parse_size(std::string_view text)
+    {
+        std::size_t scale {1};
+
+        if (!text.empty()) {
+            switch (text.back()) {
+            case 'k': case 'K':
+                scale = 1'000;
+                break;
+            case 'm': case 'M':
+                scale = 1'000'000;
+                break;
+            case 'g': case 'G':
+                scale = 1'000'000'000;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (scale != 1) text.remove_suffix(1);
+        const auto count = parse_number<std::size_t>(text);
+        if (!count || *count > std::numeric_limits<std::size_t>::max() / scale)
+            return std::nullopt;
+        return *count * scale;
+    }
+
+    // Parses a comma-separated list of sizes and size ranges. A range is
+    // written FIRST..LAST, optionally followed by :xFACTOR (the default is
+    // :x10) or :+STEP.
+    std::optional<std::vector<std::size_t>>
+    parse_sizes(const std::string_view list)
+    {
+        std::vector<std::size_t> sizes;
+
+        for (const auto item : split(list)) {
+            const auto dots = item.find("..");
+
+            if (dots == std::string_view::npos) {
+                const auto len = parse_size(item);
+                if (!len) return std::nullopt;
+                sizes.push_back(*len);
+                continue;
+            }
+
+            auto rest = item.substr(dots + 2);
+            auto step = "x10"sv;
+            if (const auto colon = rest.find(':');
+                    colon != std::string_view::npos) {
+                step = rest.substr(colon + 1);
+                rest = rest.substr(0, colon);
+            }
+
+            const auto first = parse_size(item.substr(0, dots));
+            const auto last = parse_size(rest);
+            if (!first || !last || step.empty()) return std::nullopt;
+
+            if (step.front() == '+') {
+                const auto delta = parse_size(step.substr(1));
+                if (!delta || *delta == 0) return std::nullopt;
+
+                for (auto len = *first; len <= *last; len += *delta) {
+                    sizes.push_back(len);
+                    if (*last - len < *delta) break;
+                }
+            } else if (step.front() == 'x' || step.front() == '*') {
+                const auto factor = parse_number<double>(step.substr(1));
+                if (!factor || !(*factor > 1.0) || *first == 0)
+                    return std::nullopt;
+
+                for (auto len = *first; len <= *last; ) {
+                    sizes.push_back(len);
+
+                    const auto next = static_cast<double>(len) * *factor;
+                    if (!(next <= static_cast<double>(*last))) break;
+                    len = std::max(len + 1, static_cast<std::size_t>(
+                            std::llround(next)));
+                }
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        return sizes;
+    }
+}
+
+#endif // !SORTS_OPTIONS_H
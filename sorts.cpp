@@ -12,1136 +12,3386 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <map>
 #include <memory>
+#include <new>
+#include <numeric>
+#include <optional>
 #include <random>
+#include <regex>
+#include <sstream>
 #include <stack>
+#include <stdexcept>
+#include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#ifdef __unix__
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "counters.h"
+#include "options.h"
+#include "sorts.h"
+
+// Defines SORTS_GIT_REVISION, if the build wrote it (as cmake does).
+#if __has_include("git_revision.h")
+#include "git_revision.h"
+#endif
+
 namespace {
     using namespace std::string_view_literals;
 
-    template<typename It>
-    void insertion_sort(const It first, const It last)
+    std::ostream& operator<<(std::ostream& out, const std::pair<int, int>& p)
     {
-        if (first == last) return;
-
-        for (auto right = std::next(first); right != last; ++right) {
-            auto elem = std::move(*right);
+        return out << '(' << p.first << ", " << p.second << ')';
+    }
 
-            auto left = right;
-            for (; left != first && elem < *std::prev(left); --left)
-                *left = std::move(*std::prev(left));
+    template<typename C>
+    void print(const C& c, const std::string_view prefix = " ")
+    {
+        std::cout << prefix << '[';
 
-            *left = std::move(elem);
+        auto sep = "";
+        for (const auto& x : c) {
+            std::cout << sep << x;
+            sep = ", ";
         }
+
+        std::cout << ']';
     }
 
-    template<typename It>
-    void insertion_sort_byswap(const It first, const It last)
+    template<typename C>
+    void print_if_small(const C& c, const std::string_view prefix = " ")
     {
-        if (first == last) return;
+        static constexpr std::size_t print_threshold {20};
 
-        for (auto right = std::next(first); right != last; ++right) {
-            for (auto left = right; left != first && *left < *std::prev(left);
-                                    --left)
-                std::iter_swap(left, std::prev(left));
-        }
+        if (size(c) <= print_threshold) print(c, prefix);
     }
 
-    template<typename It>
-    void binary_insertion_sort(const It first, const It last)
+    // How many untimed and timed runs run_trials does of each algorithm.
+    struct Trials {
+        int warmups;
+        int timed;
+    };
+
+    // Summary statistics of a nonempty sample of times, in nanoseconds.
+    struct Summary {
+        double min;
+        double median;
+        double mean;
+        double stddev;
+        double ci95; // half-width of the 95% confidence interval of the mean
+    };
+
+    // Two-sided 95% critical values of Student's t for 1 to 30 degrees of
+    // freedom. Past that, the normal distribution's 1.96 is close enough.
+    constexpr std::array t95 = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+            2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+            2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+            2.048, 2.045, 2.042};
+
+    Summary summarize(std::vector<double> xs)
     {
-        if (first == last) return;
+        assert(!empty(xs));
+        std::sort(begin(xs), end(xs));
 
-        for (auto right = std::next(first); right != last; ++right) {
-            auto elem = std::move(*right);
+        const auto n = size(xs);
+        const auto mid = n / 2;
+        const auto median = (n % 2 != 0 ? xs[mid]
+                                        : (xs[mid - 1] + xs[mid]) / 2.0);
 
-            const auto left = std::upper_bound(first, right, elem);
-            std::move_backward(left, right, std::next(right));
+        const auto mean = std::accumulate(cbegin(xs), cend(xs), 0.0)
+                            / static_cast<double>(n);
 
-            *left = std::move(elem);
-        }
+        if (n == 1) return {xs.front(), median, mean, 0.0, 0.0};
+
+        const auto sum_sq = std::accumulate(cbegin(xs), cend(xs), 0.0,
+                                            [mean](const double acc,
+                                                   const double x) {
+            return acc + (x - mean) * (x - mean);
+        });
+        const auto stddev = std::sqrt(sum_sq / static_cast<double>(n - 1));
+
+        const auto t = (n - 1 <= size(t95) ? t95[n - 2] : 1.96);
+        const auto ci95 = t * stddev / std::sqrt(static_cast<double>(n));
+
+        return {xs.front(), median, mean, stddev, ci95};
     }
 
-    template<typename It>
-    void binary_insertion_sort_byrotate(const It first, const It last)
+    // A time to print with a unit suited to its magnitude.
+    struct Nanoseconds {
+        double count;
+    };
+
+    std::ostream& operator<<(std::ostream& out, const Nanoseconds ns)
     {
-        if (first == last) return;
+        constexpr std::array<std::tuple<double, std::string_view>, 3> units {{
+                {1e9, "s"sv}, {1e6, "ms"sv}, {1e3, "us"sv}}};
 
-        for (auto right = std::next(first); right != last; ++right) {
-            const auto left = std::upper_bound(first, right, *right);
-            std::rotate(left, right, std::next(right));
-        }
+        for (const auto& [scale, unit] : units)
+            if (ns.count >= scale) return out << ns.count / scale << unit;
+
+        return out << ns.count << "ns";
     }
 
-    template<typename It>
-    void selection_sort(It first, const It last)
+    // Prints the per-element cost, and the cost relative to n lg n, so times
+    // can be compared across sizes.
+    void print_scaled_costs(const double ns, const std::size_t len)
     {
-        for (; first != last; ++first)
-            std::iter_swap(std::min_element(first, last), first);
+        if (len == 0) return;
+
+        const auto n = static_cast<double>(len);
+        std::cout << ", " << ns / n << " ns/elem";
+        if (len > 1) std::cout << ", " << ns / (n * std::log2(n)) << " ns/nlgn";
     }
 
-    template<typename It>
-    void bubble_sort(const It first, const It last)
-    {
-        if (first == last) return;
+    // Allocations through the global operator new, which this program
+    // replaces (below main) to keep these up to date.
+    struct AllocationStats {
+        std::size_t count;
+        std::size_t bytes;
+        std::size_t live;   // bytes allocated but not yet freed
+        std::size_t peak;   // the most bytes live since peak was last reset
+    };
 
-        for (auto again = true; again; ) {
-            again = false;
+    // The running AllocationStats. They are atomic because the threads
+    // fingerprints::of starts allocate and free their own bookkeeping while
+    // the main thread may be allocating. Relaxed order suffices, as they are
+    // only read between timed runs, when no other thread is running.
+    class SharedAllocationStats {
+    public:
+        AllocationStats load() const noexcept
+        {
+            return {count_.load(std::memory_order_relaxed),
+                    bytes_.load(std::memory_order_relaxed),
+                    live_.load(std::memory_order_relaxed),
+                    peak_.load(std::memory_order_relaxed)};
+        }
 
-            for (auto left = first, right = std::next(left); right != last;
-                                                             ++left, ++right) {
-                if (*right < *left) {
-                    std::iter_swap(left, right);
-                    again = true;
-                }
-            }
+        void reset_peak() noexcept
+        {
+            peak_.store(live_.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
         }
-    }
 
-    template<typename It>
-    void bubble_sort_nonadaptive(const It first, It last)
-    {
-        for (; first != last; --last) {
-            for (auto left = first, right = std::next(left); right != last;
-                                                             ++left, ++right) {
-                if (*right < *left) std::iter_swap(left, right);
-            }
+        void allocated(const std::size_t size) noexcept
+        {
+            count_.fetch_add(1, std::memory_order_relaxed);
+            bytes_.fetch_add(size, std::memory_order_relaxed);
+            const auto live = live_.fetch_add(size, std::memory_order_relaxed)
+                                + size;
+
+            auto peak = peak_.load(std::memory_order_relaxed);
+            while (peak < live && !peak_.compare_exchange_weak(
+                                    peak, live, std::memory_order_relaxed)) { }
         }
-    }
 
-    template<typename It>
-    void bubble_sort_maxadaptive(const It first, It last)
+        void freed(const std::size_t size) noexcept
+        {
+            live_.fetch_sub(size, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<std::size_t> count_ {};
+        std::atomic<std::size_t> bytes_ {};
+        std::atomic<std::size_t> live_ {};
+        std::atomic<std::size_t> peak_ {};
+    };
+
+    SharedAllocationStats allocation_stats;
+
+    // Whether operator new maps large blocks itself, prefaulted and backed
+    // by transparent huge pages where possible, so that timed runs don't
+    // pay for faulting in their working buffers (Linux only).
+    bool map_large_blocks {false};
+
+    // The process's resident set size in bytes, from /proc/self/statm, if
+    // it can be read.
+    std::optional<std::size_t> resident_bytes()
     {
-        while (first != last) {
-            auto last_swapped = first;
+#ifdef __linux__
+        std::ifstream in {"/proc/self/statm"};
+        std::size_t total_pages {}, resident_pages {};
+        if (!(in >> total_pages >> resident_pages)) return std::nullopt;
+        return resident_pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return std::nullopt;
+#endif
+    }
 
-            for (auto left = first, right = std::next(left); right != last;
-                                                             ++left, ++right) {
-                if (*right < *left) {
-                    std::iter_swap(left, right);
-                    last_swapped = right;
-                }
-            }
+    // Memory used by one timed run.
+    struct AllocationSample {
+        std::size_t count;      // allocations
+        std::size_t bytes;      // bytes allocated, in all
+        std::size_t peak;       // most bytes live at once, above the start
+        std::optional<double> rss_delta; // change in resident bytes
+    };
+
+    // A number of bytes to print with a binary unit suited to its magnitude.
+    struct Bytes {
+        double count;
+    };
 
-            last = last_swapped;
+    std::ostream& operator<<(std::ostream& out, const Bytes bytes)
+    {
+        constexpr std::array<std::tuple<double, std::string_view>, 3> units {{
+                {1024.0 * 1024.0 * 1024.0, "GiB"sv},
+                {1024.0 * 1024.0, "MiB"sv},
+                {1024.0, "KiB"sv}}};
+
+        for (const auto& [scale, unit] : units) {
+            if (std::abs(bytes.count) >= scale)
+                return out << bytes.count / scale << unit;
         }
+
+        return out << bytes.count << 'B';
     }
 
-    template<typename It>
-    void gnome_sort(const It first, const It last)
+    // Prints the most memory any timed run used.
+    void print_allocations(const std::vector<AllocationSample>& samples)
     {
-        for (auto cur = first; cur != last; ) {
-            if (cur == first || !(*cur < *std::prev(cur))) {
-                ++cur;
-            } else {
-                std::iter_swap(cur, std::prev(cur));
-                --cur;
-            }
+        if (empty(samples)) return;
+
+        AllocationSample most {0, 0, 0, std::nullopt};
+        for (const auto& [count, bytes, peak, rss_delta] : samples) {
+            most.count = std::max(most.count, count);
+            most.bytes = std::max(most.bytes, bytes);
+            most.peak = std::max(most.peak, peak);
+            if (rss_delta)
+                most.rss_delta = std::max(most.rss_delta.value_or(*rss_delta),
+                                          *rss_delta);
+        }
+
+        std::cout << "    " << most.count << " allocations of "
+                  << Bytes{static_cast<double>(most.bytes)} << ", peak "
+                  << Bytes{static_cast<double>(most.peak)};
+        if (most.rss_delta) {
+            std::cout << ", RSS " << (*most.rss_delta >= 0.0 ? "+" : "")
+                      << Bytes{*most.rss_delta};
         }
+        std::cout << '\n';
     }
 
-    namespace detail {
-        template<typename It>
-        using Delta = typename std::iterator_traits<It>::difference_type;
+    // This machine's memory speed over a working set of some size, which
+    // bounds how fast any algorithm can pass over an input that size.
+    namespace calibration {
+        struct Bandwidth {
+            double read;    // bytes summed per nanosecond
+            double write;   // bytes filled per nanosecond
+            double copy;    // bytes copied per nanosecond
+            double latency; // nanoseconds per dependent random access
+        };
+
+        // The best rate at which f processes units, over at least three
+        // repetitions lasting at least 20 ms in all.
+        template<typename F>
+        double best_rate(const double units, const F f)
+        {
+            using Clock = std::chrono::steady_clock;
+            using Ns = std::chrono::duration<double, std::nano>;
+
+            constexpr auto min_time = 20'000'000.0; // ns
+
+            auto best = 0.0, total = 0.0;
+            for (auto reps = 0; reps < 3 || total < min_time; ++reps) {
+                const auto start = Clock::now();
+                f();
+                const auto elapsed = Ns{Clock::now() - start}.count();
+                total += elapsed;
+                best = std::max(best, units / std::max(elapsed, 1.0));
+            }
+
+            return best;
+        }
 
-        template<typename It>
-        void insertion_sort_subsequence(const It first, const It last,
-                                        const Delta<It> gap)
+        Bandwidth measure(const std::size_t bytes)
         {
-            const auto len = last - first;
+            using Word = std::uint64_t;
 
-            for (auto right = gap; right < len; right += gap) {
-                auto elem = std::move(first[right]);
+            constexpr std::size_t chase_steps = 1 << 20;
 
-                auto left = right;
-                for (; left != 0 && elem < first[left - gap]; left -= gap)
-                    first[left] = std::move(first[left - gap]);
+            const auto len = std::max(bytes / sizeof(Word), std::size_t{512});
+            const auto total = static_cast<double>(len * sizeof(Word));
 
-                first[left] = std::move(elem);
+            std::vector<Word> a (len), b (len);
+            std::iota(begin(a), end(a), Word{});
+            volatile Word sink {};
+            Word fill {};
+
+            const auto read = best_rate(total, [&] {
+                sink = std::accumulate(cbegin(a), cend(a), Word{});
+            });
+
+            const auto write = best_rate(total, [&] {
+                std::fill(begin(b), end(b), ++fill);
+                sink = b[len / 2];
+            });
+
+            const auto copy = best_rate(total, [&] {
+                std::copy(cbegin(a), cend(a), begin(b));
+                sink = b[len / 2];
+            });
+
+            // Make one cycle through all the words in random order
+            // (Sattolo's algorithm), so each access depends on the last.
+            std::mt19937_64 eng {len};
+            for (auto i = len - 1; i != 0; --i) {
+                std::uniform_int_distribution<std::size_t> dist {0, i - 1};
+                std::swap(a[i], a[dist(eng)]);
             }
-        }
 
-        template<typename It, typename Gen>
-        void shellsort(const It first, const It last, const Gen generate_gaps)
-        {
-            // Get the gap sequence.
-            std::vector<Delta<It>> gaps;
-            generate_gaps(last - first, std::back_inserter(gaps));
-            assert(empty(gaps) || gaps.front() == 1);
-
-            // Do all nonoverlapping gapped insertion sorts for each gap value.
-            std::for_each(std::crbegin(gaps), std::crend(gaps),
-                          [first, last](const Delta<It> gap) {
-                const auto bound = first + gap;
-
-                for (auto start = first; start != bound; ++start)
-                    insertion_sort_subsequence(start, last, gap);
+            const auto accesses = best_rate(chase_steps, [&] {
+                Word i {};
+                for (std::size_t k = 0; k != chase_steps; ++k) i = a[i];
+                sink = i;
             });
+
+            return {read, write, copy, 1.0 / accesses};
         }
 
-        // This ratio appears in the computations of some of the experimentally
-        // faster (average-case) gap sequences for shellsort.
-        constexpr auto nine_fourths = 2.25;
+        // Measures the bandwidth over a working set of the given size, once
+        // for each size.
+        const Bandwidth& at(const std::size_t bytes)
+        {
+            static std::map<std::size_t, Bandwidth> cache;
 
-        // This is the fastest known sequence in the average case, based on
-        // experimental evidence. Only nine terms are known (with no formula).
-        constexpr std::array ciura_gaps = {
-                1, 4, 10, 23, 57, 132, 301, 701, 1750};
-    }
+            const auto p = cache.find(bytes);
+            if (p != cend(cache)) return p->second;
+            return cache.emplace(bytes, measure(bytes)).first->second;
+        }
 
-    namespace detail::gaps {
-        // Generates gaps consisting of one less than powers of 2. Found by
-        // Hibbard 1963: https://dl.acm.org/citation.cfm?doid=366552.366557
-        constexpr auto hibbard = [](const auto len, auto d_first) {
-            for (auto k = 1; ; ++k) {
-                const auto g = (decltype(len){1} << k) - 1;
-                if (g >= len) break;
-                *d_first++ = g;
-            }
+        // Prints a calibration, in GB/s and nanoseconds.
+        void print(const Bandwidth& bandwidth, const std::size_t bytes)
+        {
+            std::cout << "Memory over " << Bytes{static_cast<double>(bytes)}
+                      << ": read " << bandwidth.read << " GB/s, write "
+                      << bandwidth.write << " GB/s, copy " << bandwidth.copy
+                      << " GB/s, random access " << bandwidth.latency
+                      << " ns.\n";
+        }
+
+        // Lower bounds on an algorithm's time on an input, in nanoseconds.
+        struct Bounds {
+            Bandwidth bandwidth;
+            double pass;    // to copy the input once, as any sort that moves
+                            // its elements must at least do
+            double access;  // to make one random access per element
         };
 
-        // Generates gaps consisting of the 3-smooth numbers. Pratt 1971 showed
-        // shellsort with this sequence has optimal worst-case asymptotic time
-        // complexity, http://www.dtic.mil/get-tr-doc/pdf?AD=AD0740110, but on
-        // average it is slower than the popular sequences. I generate them with
-        // David Eisenstat's method https://stackoverflow.com/a/25344494
-        // (Eisenstat 2014) based on Dijkstra's solution to the Hamming problem
-        // (Dijkstra 1976, see https://en.wikipedia.org/wiki/Regular_number).
-        constexpr auto three_smooth = [](const auto len, auto d_first) {
-            std::vector<std::remove_const_t<decltype(len)>> aux;
-            decltype(size(aux)) co_two_pos {}, co_three_pos {};
+        Bounds bounds(const Bandwidth& bandwidth, const std::size_t len,
+                      const std::size_t bytes)
+        {
+            return {bandwidth,
+                    static_cast<double>(bytes) / bandwidth.copy,
+                    static_cast<double>(len) * bandwidth.latency};
+        }
 
-            for (aux.push_back({1}); aux.back() < len; ) {
-                *d_first++ = aux.back();
+        // Prints a median time as multiples of the bounds.
+        void print_roofline(const Bounds& bounds, const double ns)
+        {
+            if (bounds.access == 0.0) return;
 
-                const auto two_multiple = aux[co_two_pos] * 2;
-                const auto three_multiple = aux[co_three_pos] * 3;
+            std::cout << "    " << ns / bounds.pass << " copy passes, or "
+                      << ns / bounds.access << " random accesses/elem\n";
+        }
+    }
 
-                aux.push_back(std::min(two_multiple, three_multiple));
+    // How many times elements were compared, copied, moved, and swapped.
+    struct OperationCounts {
+        std::size_t comparisons;
+        std::size_t copies;
+        std::size_t moves;
+        std::size_t swaps;
+    };
 
-                if (two_multiple <= three_multiple) ++co_two_pos;
-                if (three_multiple <= two_multiple) ++co_three_pos;
-            }
-        };
+    // Counts of operations on Counted elements by the current thread.
+    thread_local OperationCounts operation_counts {};
 
-        // Generate gaps whose rate of increase gradually rises. Found by
-        // Sedgewick 1986: https://doi.org/10.1016/0196-6774(86)90001-5 p.165
-        // See also https://oeis.org/A036562.
-        constexpr auto sedgewick = [](const auto len, auto d_first) {
-            if (len == 0) return;
+    namespace counters {
+        // Warns about events that can't be counted.
+        void report_unavailable(const PerfCounters& counters)
+        {
+            std::string missing;
 
-            constexpr decltype(len) one {1};
-            *d_first++ = one;
+            for (std::size_t i = 0; i != event_count; ++i) {
+                if (counters.available(static_cast<Event>(i))) continue;
+                if (!missing.empty()) missing += ", ";
+                missing += event_names[i];
+            }
 
-            for (auto i = 0; ; ++i) {
-                const auto g = (one << (i + 1) * 2) + (one << i) * 3 + 1;
-                if (g >= len) break;
-                *d_first++ = g;
+            if (!missing.empty()) {
+                std::cerr << "warning: can't count " << missing
+                          << " (perf_event_open is unavailable or not"
+                             " permitted; see perf_event_paranoid)\n";
             }
-        };
+        }
 
-        // Generates gaps that increase by a bit more than 9/4. Found by
-        // Tokuda 1992: https://dl.acm.org/citation.cfm?id=659879. See also
-        // https://oeis.org/A108870. The formula used here appears in
-        // https://en.wikipedia.org/wiki/Shellsort#Gap_sequences.
-        constexpr auto tokuda = [](const auto len, auto d_first) {
-            for (auto h = 1.0; ; h = h * nine_fourths + 1.0) {
-                const auto g = static_cast<decltype(len)>(std::ceil(h));
-                if (g >= len) break;
-                *d_first++ = g;
+        // Prints the mean counts of runs per element, and instructions per
+        // cycle, for the events that were counted.
+        void print_counts(const std::vector<Sample>& samples,
+                          const std::size_t len)
+        {
+            if (empty(samples) || len == 0) return;
+
+            Sample means;
+            for (std::size_t i = 0; i != event_count; ++i) {
+                auto sum = 0.0;
+                auto counted = true;
+                for (const auto& sample : samples) {
+                    if (!sample[i]) counted = false;
+                    else sum += *sample[i];
+                }
+                if (counted)
+                    means[i] = sum / static_cast<double>(size(samples));
             }
-        };
 
-        // Generates gaps that increase according to the short experimentally
-        // derived sequence in Ciura 2001, and then by a bit less than 9/4. See
-        // http://sun.aei.polsl.pl/~mciura/publikacje/shellsort.pdf and
-        // https://oeis.org/A102549 for the initial sequence and
-        // https://en.wikipedia.org/wiki/Shellsort#Gap_sequences for the
-        // idea of extending it in this way.
-        constexpr auto quasi_ciura = [](const auto len, auto d_first) {
-            auto g = decltype(len){};
-
-            for (const auto h : ciura_gaps) {
-                g = decltype(len){h};
-                if (g >= len) return;
-                *d_first++ = g;
+            const auto n = static_cast<double>(len);
+            auto first = true;
+            const auto separate = [&first] {
+                std::cout << (first ? "    " : ", ");
+                first = false;
+            };
+
+            if (means[cycles] && means[instructions] && *means[cycles] > 0.0) {
+                separate();
+                std::cout << *means[instructions] / *means[cycles] << " IPC";
             }
 
-            while ((g = static_cast<decltype(len)>(g * nine_fourths)) < len)
-                *d_first++ = g;
-        };
-    }
+            for (std::size_t i = 0; i != event_count; ++i) {
+                if (!means[i]) continue;
+                separate();
+                std::cout << *means[i] / n << ' ' << event_names[i] << "/elem";
+            }
 
-    template<typename It>
-    void shellsort_hibbard(const It first, const It last)
-    {
-        detail::shellsort(first, last, detail::gaps::hibbard);
+            if (!first) std::cout << '\n';
+        }
     }
 
-    template<typename It>
-    void shellsort_3smooth(const It first, const It last)
-    {
-        detail::shellsort(first, last, detail::gaps::three_smooth);
-    }
+    // Order-independent fingerprints of multisets of elements, to check
+    // that a sort's output is a permutation of its input.
+    namespace fingerprints {
+        // The splitmix64 step, a strong 64-bit mix that maps 0 to nonzero.
+        constexpr std::uint64_t mix(std::uint64_t x) noexcept
+        {
+            x += 0x9e37'79b9'7f4a'7c15u;
+            x = (x ^ (x >> 30)) * 0xbf58'476d'1ce4'e5b9u;
+            x = (x ^ (x >> 27)) * 0x94d0'49bb'1331'11ebu;
+            return x ^ (x >> 31);
+        }
 
-    template<typename It>
-    void shellsort_sedgewick(const It first, const It last)
-    {
-        detail::shellsort(first, last, detail::gaps::sedgewick);
-    }
+        // Hashes len bytes, a word at a time.
+        std::uint64_t hash_bytes(const unsigned char* const bytes,
+                                 const std::size_t len) noexcept
+        {
+            auto h = mix(len);
 
-    template<typename It>
-    void shellsort_tokuda(const It first, const It last)
-    {
-        detail::shellsort(first, last, detail::gaps::tokuda);
-    }
+            for (std::size_t i = 0; i < len; i += sizeof(std::uint64_t)) {
+                std::uint64_t word {};
+                std::memcpy(&word, bytes + i,
+                            std::min(len - i, sizeof(std::uint64_t)));
+                h = mix(h ^ word);
+            }
 
-    template<typename It>
-    void shellsort_quasi_ciura(const It first, const It last)
-    {
-        detail::shellsort(first, last, detail::gaps::quasi_ciura);
-    }
+            return h;
+        }
 
-    namespace detail {
-        template<typename It>
-        constexpr bool possibly_unsorted(It first, const It last) noexcept
+        // Hashes an element with no padding or alternative representations
+        // by its bytes.
+        template<typename T>
+        std::uint64_t hash(const T& x) noexcept
         {
-            return first != last && ++first != last;
+            static_assert(std::has_unique_object_representations_v<T>);
+
+            if constexpr (sizeof x <= sizeof(std::uint64_t)) {
+                std::uint64_t word {};
+                std::memcpy(&word, &x, sizeof x);
+                return mix(word);
+            } else {
+                return hash_bytes(reinterpret_cast<const unsigned char*>(&x),
+                                  sizeof x);
+            }
         }
 
-        template<typename It>
-        constexpr It midpoint(It first, const It last) noexcept
+        std::uint64_t hash(const double x) noexcept
         {
-            std::advance(first, std::distance(first, last) / 2);
-            return first;
+            std::uint64_t bits {};
+            std::memcpy(&bits, &x, sizeof x);
+            return mix(bits);
         }
 
-        template<typename It>
-        auto
-        make_aux(const Delta<It> len)
+        std::uint64_t hash(const std::string& s) noexcept
         {
-            using T = typename std::iterator_traits<It>::value_type;
-
-            std::vector<T> aux;
-            aux.reserve(static_cast<typename std::vector<T>::size_type>(len));
-            return aux;
+            return hash_bytes(reinterpret_cast<const unsigned char*>(data(s)),
+                              size(s));
         }
 
-        template<typename T, typename It>
-        void merge(std::vector<T>& aux, const It first1, // "last1" is first2
-                                        const It first2, const It last2)
+        template<typename T, typename U>
+        std::uint64_t hash(const std::pair<T, U>& p) noexcept
         {
-            auto cur1 = first1, cur2 = first2;
+            return mix(hash(p.first) ^ mix(hash(p.second)));
+        }
 
-            // Merge elements from both ranges to aux until one is empty.
-            while (cur1 != first2 && cur2 != last2) {
-                auto& cur = (*cur2 < *cur1 ? cur2 : cur1);
-                aux.push_back(std::move(*cur));
-                ++cur;
+        // The sum of the elements' hashes, so any lost, duplicated, or
+        // changed element almost surely changes it. Large ranges are summed
+        // in parallel.
+        template<typename T>
+        std::uint64_t of(const std::vector<T>& v)
+        {
+            constexpr std::size_t min_chunk = 1 << 20;
+
+            const auto sum = [&v](const std::size_t first,
+                                  const std::size_t last) {
+                std::uint64_t total {};
+                for (auto i = first; i != last; ++i) total += hash(v[i]);
+                return total;
+            };
+
+            const auto count = std::clamp(
+                    size(v) / min_chunk, std::size_t{1},
+                    std::size_t{std::max(std::thread::hardware_concurrency(),
+                                         1u)});
+            const auto bound = [&v, count](const std::size_t k) {
+                return size(v) * k / count;
+            };
+
+            std::vector<std::uint64_t> sums (count);
+            std::vector<std::thread> workers;
+            workers.reserve(count - 1);
+            for (std::size_t k = 1; k != count; ++k) {
+                workers.emplace_back([&sums, &sum, &bound, k] {
+                    sums[k] = sum(bound(k), bound(k + 1));
+                });
             }
 
-            // Move the remaining elements from whichever range has them.
-            std::move(cur1, first2, back_inserter(aux));
-            std::move(cur2, last2, back_inserter(aux));
+            sums[0] = sum(bound(0), bound(1));
+            for (auto& worker : workers) worker.join();
 
-            // Move everything back.
-            std::move(cbegin(aux), cend(aux), first1);
-            aux.clear();
+            return std::accumulate(cbegin(sums), cend(sums),
+                                   std::uint64_t{});
         }
     }
 
-    template<typename It>
-    void mergesort_topdown(const It first, const It last)
-    {
-        auto aux = detail::make_aux<It>(std::distance(first, last));
-
-        const auto mergesort_subrange = [&aux](const auto& me, const It first1,
-                                                               const It last2) {
-            const auto delta = std::distance(first1, last2) / 2;
-            if (delta == 0) return;
+    // The times of an algorithm's timed runs on one input, whether every
+    // run sorted it into a permutation of it, and each timed run's event
+    // counts, if counted.
+    struct Measurement {
+        std::vector<double> times; // in nanoseconds
+        Summary summary;
+        bool ok;
+        std::vector<counters::Sample> samples;
+        std::vector<AllocationSample> allocations;
+        std::optional<OperationCounts> operations; // set after run_trials
+        std::optional<calibration::Bounds> bounds; // likewise
+        std::optional<bool> stable; // likewise, if checked
+    };
 
-            const auto first2 = std::next(first1, delta);
-            me(me, first1, first2);
-            me(me, first2, last2);
-            detail::merge(aux, first1, first2, last2);
-        };
+    // The most elements of an input sorts_stably checks, which bounds the
+    // memory its indexed copy takes.
+    constexpr std::size_t max_stability_check_length {1 << 20};
 
-        mergesort_subrange(mergesort_subrange, first, last);
+    // Prints a measurement's statistics and correctness, after its label.
+    void print_measurement(const Measurement& m, const std::size_t len)
+    {
+        const auto [min, median, mean, stddev, ci95] = m.summary;
+        std::cout << " median " << Nanoseconds{median}
+                  << " (min " << Nanoseconds{min}
+                  << ", mean " << Nanoseconds{mean}
+                  << " +/- " << Nanoseconds{ci95}
+                  << ", sd " << Nanoseconds{stddev}
+                  << ", " << size(m.times) << " trials)";
+        print_scaled_costs(median, len);
+
+        const auto good = m.ok && m.stable != false;
+        std::cout << ' ' << (!m.ok ? "FAIL!!!"
+                             : !good ? "UNSTABLE!!!" : "OK");
+        if (m.stable && len > max_stability_check_length) {
+            std::cout << " (stability checked on the first "
+                      << max_stability_check_length << " elements)";
+        }
+        std::cout << (good ? ".\n" : "\n");
     }
 
-    template<typename It>
-    void mergesort_topdown_iterative(It first, It last)
+    // Runs an algorithm on copies of an input, timing all but the
+    // warm-up runs. If show is true, prints the result if it is small. If
+    // count_events is true, counts events during each timed run. Each run
+    // sorts work, a buffer as long as c, after c is copied into it, and
+    // must leave it with c's fingerprint.
+    template<typename T>
+    Measurement run_trials(const std::vector<T>& c, std::vector<T>& work,
+                           const Algorithm<T>& algorithm, const Trials& trials,
+                           const bool show, const bool count_events,
+                           const std::uint64_t fingerprint)
     {
-        auto aux = detail::make_aux<It>(std::distance(first, last));
-        auto post_first = last, post_last = last; // a "null" interval
-        std::stack<std::tuple<It, It>> intervals;
-
-        while (first != last || !empty(intervals)) {
-            // Traverse left as far as possible.
-            for (; first != last; last = detail::midpoint(first, last))
-                intervals.emplace(first, last);
-
-            const auto [first1, last2] = intervals.top();
+        assert(size(work) == size(c));
+
+        using Clock = std::chrono::steady_clock;
+        using Ns = std::chrono::duration<double, std::nano>;
+
+        std::vector<double> times;
+        times.reserve(static_cast<std::size_t>(trials.timed));
+        std::vector<counters::Sample> samples;
+        std::vector<AllocationSample> allocations;
+        auto ok = true;
+
+        std::optional<counters::PerfCounters> perf;
+        if (count_events) perf.emplace();
+
+        for (auto i = -trials.warmups; i != trials.timed; ++i) {
+            // Restore the input. This touches every page of the buffer, so
+            // page faults from its first use aren't charged to the run.
+            std::copy(cbegin(c), cend(c), begin(work));
+            auto& d = work;
+            const auto counting = (perf && i >= 0);
+
+            const auto rss_before = resident_bytes();
+            const auto stats_before = allocation_stats.load();
+            allocation_stats.reset_peak();
+
+            if (counting) perf->start();
+            const auto ti = Clock::now();
+            algorithm.sort(data(d), data(d) + size(d));
+            const auto tf = Clock::now();
+            std::optional<counters::Sample> sample;
+            if (counting) sample = perf->stop();
+
+            const auto stats_after = allocation_stats.load();
+            const auto rss_after = resident_bytes();
+            if (sample) samples.push_back(*sample);
+
+            if (i >= 0) {
+                times.push_back(Ns{tf - ti}.count());
+
+                std::optional<double> rss_delta;
+                if (rss_before && rss_after) {
+                    rss_delta = static_cast<double>(*rss_after)
+                                - static_cast<double>(*rss_before);
+                }
 
-            if (const auto first2 = detail::midpoint(first1, last2);
-                    // The right branch is big enough to need sorting...
-                    detail::possibly_unsorted(first2, last2)
-                    // ...and we were not just there.
-                        && (first2 != post_first || last2 != post_last)) {
-                // Traverse there next.
-                first = first2;
-                last = last2;
-            } else {
-                // Merge the left and right branches and retreat.
-                detail::merge(aux, first1, first2, last2);
-                post_first = first1;
-                post_last = last2;
-                intervals.pop();
+                allocations.push_back({stats_after.count - stats_before.count,
+                                       stats_after.bytes - stats_before.bytes,
+                                       stats_after.peak - stats_before.live,
+                                       rss_delta});
             }
+
+            ok = ok && std::is_sorted(cbegin(d), cend(d))
+                    && fingerprints::of(d) == fingerprint;
+            if (show && i == trials.timed - 1) print_if_small(d);
         }
+
+        const auto summary = summarize(times);
+        return {std::move(times), summary, ok, std::move(samples),
+                std::move(allocations), {}, {}, {}};
     }
 
-    template<typename It>
-    void mergesort_bottomup_iterative(const It first, const It last)
+    // Predicts an algorithm's median time on len elements, from its median
+    // times on smaller inputs, as t = a n^b. The exponent b is fitted to the
+    // two largest inputs that took long enough to time reliably, clamped to
+    // [1, 3], or assumed if there are fewer than two such inputs.
+    std::optional<double>
+    predict_time(const std::vector<std::tuple<std::size_t, double>>& history,
+                 const std::size_t len, const double assumed_exponent)
     {
-        const auto len = std::distance(first, last);
-        auto aux = detail::make_aux<It>(len);
+        constexpr auto min_fit_time = 100'000.0; // ns
 
-        for (detail::Delta<It> delta1 {1}; delta1 < len; delta1 *= 2) {
-            detail::Delta<It> sublen {0};
+        std::vector<std::tuple<double, double>> points;
+        for (const auto& [n, t] : history) {
+            if (n != 0 && t >= min_fit_time)
+                points.emplace_back(static_cast<double>(n), t);
+        }
 
-            for (auto first1 = first; (sublen += delta1) < len; ) {
-                const auto first2 = std::next(first1, delta1);
-                const auto delta2 = std::min(delta1, len - sublen);
-                const auto last2 = std::next(first2, delta2);
+        if (empty(points)) return std::nullopt;
 
-                detail::merge(aux, first1, first2, last2);
+        const auto [n2, t2] = points.back();
+        auto exponent = assumed_exponent;
 
-                first1 = last2;
-                sublen += delta2;
-            }
+        if (size(points) > 1) {
+            const auto [n1, t1] = points[size(points) - 2];
+            exponent = std::clamp(std::log(t2 / t1) / std::log(n2 / n1),
+                                  1.0, 3.0);
         }
+
+        return t2 * std::pow(static_cast<double>(len) / n2, exponent);
     }
 
-    namespace detail {
-        template<typename It>
-        constexpr Delta<It> no_child {-1};
+    // Why a watched run produced no measurement.
+    struct Interruption {
+        bool overran;       // killed for going over the time limit
+        std::string reason; // how to report it
+    };
 
-        template<typename It>
-        constexpr Delta<It> pick_child(const It first, const Delta<It> len,
-                                       const Delta<It> parent)
-        {
-            const auto left = parent * 2 + 1;
-            if (left >= len) return no_child<It>;
+#ifdef __unix__
+    // Writes all of a buffer to a file descriptor, retrying short writes.
+    bool write_all(const int fd, const void* const buffer, std::size_t len)
+    {
+        auto p = static_cast<const char*>(buffer);
 
-            const auto right = left + 1;
-            return right == len || !(first[left] < first[right]) ? left : right;
+        while (len != 0) {
+            const auto count = write(fd, p, len);
+            if (count <= 0) return false;
+            p += count;
+            len -= static_cast<std::size_t>(count);
         }
+
+        return true;
     }
 
-    template<typename It>
-    void heapsort(const It first, const It last)
+    // Reads trivially copyable objects from the front of a buffer.
+    template<typename T>
+    bool take(std::string_view& buffer, T* const out, const std::size_t count)
     {
-        auto len = last - first;
-        if (len < 2) return;
+        static_assert(std::is_trivially_copyable_v<T>);
 
-        const auto sift_down = [first, &len](detail::Delta<It> parent) {
-            auto elem = std::move(first[parent]);
-
-            for (; ; ) {
-                const auto child = detail::pick_child(first, len, parent);
-                if (child == detail::no_child<It> || !(elem < first[child]))
-                    break;
+        if (size(buffer) < count * sizeof(T)) return false;
+        std::memcpy(out, data(buffer), count * sizeof(T));
+        buffer.remove_prefix(count * sizeof(T));
+        return true;
+    }
 
-                first[parent] = std::move(first[child]);
-                parent = child;
-            }
+    // Sends a measurement to another process of this program. Its summary
+    // is not sent, since it can be recomputed from its times.
+    void send_measurement(const int fd, const Measurement& m)
+    {
+        static_assert(std::is_trivially_copyable_v<counters::Sample>);
+        static_assert(std::is_trivially_copyable_v<AllocationSample>);
+        static_assert(std::is_trivially_copyable_v<decltype(m.operations)>);
+        static_assert(std::is_trivially_copyable_v<decltype(m.stable)>);
+
+        const std::array<std::size_t, 3> sizes {
+            size(m.times), size(m.samples), size(m.allocations)};
+
+        write_all(fd, data(sizes), sizeof sizes);
+        write_all(fd, data(m.times), size(m.times) * sizeof(double));
+        write_all(fd, &m.ok, sizeof m.ok);
+        write_all(fd, data(m.samples),
+                  size(m.samples) * sizeof(counters::Sample));
+        write_all(fd, data(m.allocations),
+                  size(m.allocations) * sizeof(AllocationSample));
+        write_all(fd, &m.operations, sizeof m.operations);
+        write_all(fd, &m.stable, sizeof m.stable);
+    }
 
-            first[parent] = std::move(elem);
-        };
+    // Decodes what send_measurement sent, if it was all sent.
+    std::optional<Measurement> receive_measurement(std::string_view buffer)
+    {
+        std::array<std::size_t, 3> sizes {};
+        if (!take(buffer, data(sizes), size(sizes))) return std::nullopt;
+
+        const auto [time_count, sample_count, allocation_count] = sizes;
+        if (time_count == 0) return std::nullopt;
+
+        Measurement m {std::vector<double>(time_count), {}, false,
+                       std::vector<counters::Sample>(sample_count),
+                       std::vector<AllocationSample>(allocation_count), {},
+                       {}, {}};
+
+        if (!take(buffer, data(m.times), time_count)
+                || !take(buffer, &m.ok, 1)
+                || !take(buffer, data(m.samples), sample_count)
+                || !take(buffer, data(m.allocations), allocation_count)
+                || !take(buffer, &m.operations, 1)
+                || !take(buffer, &m.stable, 1)
+                || !empty(buffer))
+            return std::nullopt;
+
+        m.summary = summarize(m.times);
+        return m;
+    }
 
-        // Rearrange the elements into a binary maxheap.
-        for (auto parent = len / 2; parent >= 0; --parent) sift_down(parent);
+    // Runs f, which returns a Measurement, in a child process, and returns
+    // the measurement, or why there is none: the child took longer than
+    // limit seconds and was killed, or it died. Output is flushed before
+    // forking, so it isn't written twice.
+    template<typename F>
+    std::variant<Measurement, Interruption> run_watched(const F f,
+                                                        const double limit)
+    {
+        std::cout.flush();
+        std::cerr.flush();
+
+        std::array<int, 2> fds {};
+        if (pipe(data(fds)) != 0) return f(); // Run unwatched.
+        const auto [read_fd, write_fd] = fds;
+
+        const auto pid = fork();
+        if (pid == -1) {
+            close(read_fd);
+            close(write_fd);
+            return f(); // Run unwatched.
+        }
 
-        // Pop each maximum element and place it just after the unsorted region.
-        while (--len != 0) {
-            std::iter_swap(first, first + len);
-            sift_down(0);
+        if (pid == 0) {
+            close(read_fd);
+            send_measurement(write_fd, f());
+            std::cout.flush();
+            _exit(EXIT_SUCCESS);
         }
-    }
 
-    template<typename It>
-    void heapsort_byswap(const It first, const It last)
-    {
-        auto len = last - first;
-        if (len < 2) return;
+        close(write_fd);
 
-        const auto sift_down = [first, &len](detail::Delta<It> parent) {
-            for (; ; ) {
-                const auto child = detail::pick_child(first, len, parent);
-                if (child == detail::no_child<It>
-                        || !(first[parent] < first[child]))
-                    break;
+        using Clock = std::chrono::steady_clock;
+        const auto deadline = Clock::now()
+                + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>{limit});
 
-                std::iter_swap(first + parent, first + child);
-                parent = child;
+        std::string buffer;
+        auto overran = false;
+
+        for (; ; ) {
+            const auto left = std::chrono::duration_cast<
+                    std::chrono::milliseconds>(deadline - Clock::now());
+            if (left.count() <= 0) {
+                overran = true;
+                break;
             }
-        };
 
-        // Rearrange the elements into a binary maxheap.
-        for (auto parent = len / 2; parent >= 0; --parent) sift_down(parent);
+            pollfd pfd {read_fd, POLLIN, 0};
+            const auto ready = poll(&pfd, 1, static_cast<int>(
+                    std::min<std::chrono::milliseconds::rep>(left.count(),
+                                                             60'000)));
+            if (ready < 0 && errno != EINTR) break;
+            if (ready <= 0) continue;
+
+            std::array<char, 4096> chunk;
+            const auto count = read(read_fd, data(chunk), size(chunk));
+            if (count <= 0) break; // end of file, or an error
+            buffer.append(data(chunk), static_cast<std::size_t>(count));
+        }
+
+        close(read_fd);
+        if (overran) kill(pid, SIGKILL);
 
-        // Pop each maximum element and place it just after the unsorted region.
-        while (--len != 0) {
-            std::iter_swap(first, first + len);
-            sift_down(0);
+        auto status = 0;
+        while (waitpid(pid, &status, 0) == -1 && errno == EINTR) { }
+
+        if (overran) {
+            std::ostringstream reason;
+            reason << "cut short after " << limit << "s";
+            return Interruption{true, reason.str()};
         }
+
+        if (auto m = receive_measurement(buffer)) return std::move(*m);
+
+        std::ostringstream reason;
+        if (WIFSIGNALED(status))
+            reason << "crashed (signal " << WTERMSIG(status) << ')';
+        else
+            reason << "failed (exit status " << WEXITSTATUS(status) << ')';
+        return Interruption{false, reason.str()};
+    }
+#else
+    // Without fork, runs f in this process, unwatched.
+    template<typename F>
+    std::variant<Measurement, Interruption> run_watched(const F f, double)
+    {
+        return f();
     }
+#endif
 
-    namespace detail {
-        template<typename It>
-        constexpr void bring_mid_to_front(const It first, const It last)
-        {
-            std::iter_swap(first, midpoint(first, last));
-        }
+    // Wraps an element, counting operations on it in operation_counts. A swap
+    // found by argument-dependent lookup, as std::iter_swap uses, counts as
+    // one swap; a qualified call to std::swap counts as three moves.
+    template<typename T>
+    class Counted {
+    public:
+        Counted() : value_{} { }
 
-        template<typename It>
-        constexpr It iter_min(const It p, const It q)
+        explicit Counted(T value) : value_(std::move(value)) { }
+
+        Counted(const Counted& other) : value_(other.value_)
         {
-            return *q < *p ? q : p;
+            ++operation_counts.copies;
         }
 
-        template<typename It>
-        constexpr It median_of_three(const It p, const It q, const It r)
+        Counted(Counted&& other) noexcept : value_(std::move(other.value_))
         {
-            if (*p < *q)
-                return *p < *r ? iter_min(q, r) : p;
-            else
-                return *q < *r ? iter_min(p, r) : q;
+            ++operation_counts.moves;
         }
 
-        template<typename It>
-        constexpr void bring_median_of_three_to_front(const It first,
-                                                      const It last)
+        ~Counted() = default;
+
+        Counted& operator=(const Counted& other)
         {
-            std::iter_swap(first, median_of_three(first,
-                                                  midpoint(first, last),
-                                                  last - 1));
+            ++operation_counts.copies;
+            value_ = other.value_;
+            return *this;
         }
 
-        // Sorts in the simple cases of two or fewer elements and returns true,
-        // or moves the median-of-three element to the front and returns false.
-        template<typename It>
-        constexpr bool sorted_after_pivot_selection(const It first, It last)
+        Counted& operator=(Counted&& other) noexcept
         {
-            if (const auto len = last - first; len < 3) {
-                if (len == 2 && *--last < *first) std::iter_swap(first, last);
-                return true;
-            }
-
-            bring_median_of_three_to_front(first, last);
-            return false;
+            ++operation_counts.moves;
+            value_ = std::move(other.value_);
+            return *this;
         }
-    }
 
-    namespace detail::partitions {
-        // Assumes [first, last) is nonempty, partitions it, and returns an
-        // iterator to the pivot. Like the Lomuto scheme, but chooses the pivot
-        // from the beginning, not the end.
-        template<typename It>
-        It lomuto(const It first, const It last)
+        friend void swap(Counted& lhs, Counted& rhs) noexcept
         {
-            const auto& pivot = *first;
-            auto mid = first;
-
-            for (auto cur = std::next(first); cur != last; ++cur)
-                if (*cur < pivot) std::iter_swap(++mid, cur);
-
-            std::iter_swap(first, mid);
-            return mid;
+            ++operation_counts.swaps;
+            using std::swap;
+            swap(lhs.value_, rhs.value_);
         }
 
-        // Hoare partition scheme. This implementation assumes the first element
-        // in the range is neither the strictly least nor the strictly greatest
-        // element.
-        template<typename It>
-        It hoare(It first, It last)
+        friend bool operator<(const Counted& lhs, const Counted& rhs)
         {
-            for (const auto& pivot = *first; ; ) {
-                while (*++first < pivot) { }
-                while (pivot < *--last) { }
-                if (first >= last) return first;
-                std::iter_swap(first, last);
-            }
+            ++operation_counts.comparisons;
+            return lhs.value_ < rhs.value_;
         }
-    }
 
-    // Quicksort, using Lomuto partition but choosing the pivot from the middle
-    // of the array (by swapping the first and middle elements and then using
-    // the first element as the pivot). This is the K&R 2 algorithm (p. 87).
-    template<typename It>
-    void quicksort_lomuto_simple(const It first, const It last)
+    private:
+        T value_;
+    };
+
+    // Runs an algorithm once on a copy of an input whose elements are
+    // wrapped in Counted, and returns the counts of operations it did.
+    template<typename T>
+    OperationCounts count_operations(const std::vector<T>& c,
+                                     const Algorithm<Counted<T>>& algorithm)
     {
-        if (detail::possibly_unsorted(first, last)) {
-            detail::bring_mid_to_front(first, last);
-            auto mid = detail::partitions::lomuto(first, last);
-            quicksort_lomuto_simple(first, mid);
-            quicksort_lomuto_simple(++mid, last);
-        }
+        std::vector<Counted<T>> counted (cbegin(c), cend(c));
+
+        operation_counts = {};
+        algorithm.sort(data(counted), data(counted) + size(counted));
+        return operation_counts;
     }
 
-    // Same as quicksort_lomuto_simple, but implemented iteratively.
-    template<typename It>
-    void quicksort_lomuto_simple_iterative(It first, It last)
+    // Whether an algorithm keeps equal elements of an input in their
+    // original order, running it once on an indexed copy of (at most the
+    // first max_stability_check_length elements of) the input.
+    template<typename T>
+    bool sorts_stably(const std::vector<T>& c,
+                      const Algorithm<Indexed<T>>& algorithm)
     {
-        std::stack<std::tuple<It, It>> intervals;
-        intervals.emplace(first, last);
-
-        while (!empty(intervals)) {
-            std::tie(first, last) = intervals.top();
-            intervals.pop();
+        const auto len = std::min(size(c), max_stability_check_length);
 
-            if (!detail::possibly_unsorted(first, last)) continue;
+        std::vector<Indexed<T>> indexed;
+        indexed.reserve(len);
+        for (std::size_t i = 0; i != len; ++i) indexed.push_back({c[i], i});
 
-            detail::bring_mid_to_front(first, last);
-            const auto mid = detail::partitions::lomuto(first, last);
-            intervals.emplace(std::next(mid), last);
-            intervals.emplace(first, mid);
-        }
-    }
+        algorithm.sort(data(indexed), data(indexed) + size(indexed));
 
-    // Quicksort, using Lomuto partition but choosing the pivot via the median-
-    // of-three technique.
-    template<typename It>
-    void quicksort_lomuto(const It first, const It last)
-    {
-        if (detail::sorted_after_pivot_selection(first, last)) return;
-        auto mid = detail::partitions::lomuto(first, last);
-        quicksort_lomuto(first, mid);
-        quicksort_lomuto(++mid, last);
+        return std::adjacent_find(cbegin(indexed), cend(indexed),
+                                  [](const auto& lhs, const auto& rhs) {
+            return !(lhs < rhs) && rhs.index < lhs.index;
+        }) == cend(indexed);
     }
 
-    // Same as quicksort_lomuto, but implemented iteratively.
-    template<typename It>
-    void quicksort_lomuto_iterative(It first, It last)
+    // Prints operation counts per element.
+    void print_operation_counts(const OperationCounts& counts,
+                                const std::size_t len)
     {
-        std::stack<std::tuple<It, It>> intervals;
-        intervals.emplace(first, last);
+        if (len == 0) return;
 
-        while (!empty(intervals)) {
-            std::tie(first, last) = intervals.top();
-            intervals.pop();
+        const auto n = static_cast<double>(len);
+        const auto per_element = [n](const std::size_t count) {
+            return static_cast<double>(count) / n;
+        };
 
-            if (detail::sorted_after_pivot_selection(first, last)) continue;
-            const auto mid = detail::partitions::lomuto(first, last);
-            intervals.emplace(mid + 1, last);
-            intervals.emplace(first, mid);
-        }
+        std::cout << "    " << per_element(counts.comparisons)
+                  << " comparisons/elem, " << per_element(counts.copies)
+                  << " copies/elem, " << per_element(counts.moves)
+                  << " moves/elem, " << per_element(counts.swaps)
+                  << " swaps/elem\n";
     }
 
-    // Quicksort using Hoare partition.
-    template<typename It>
-    void quicksort_hoare(const It first, const It last)
+    template<typename C, typename F, typename P>
+    void count_one(const C& c, const F f, const P is_chosen)
     {
-        if (detail::sorted_after_pivot_selection(first, last)) return;
-        auto mid = detail::partitions::hoare(first, last);
-        quicksort_hoare(first, mid);
-        quicksort_hoare(mid, last);
-    }
+        using std::begin, std::end;
 
-    // Quicksort using Hoare partition, but implemented iteratively.
-    template<typename It>
-    void quicksort_hoare_iterative(It first, It last)
-    {
-        std::stack<std::tuple<It, It>> intervals;
-        intervals.emplace(first, last);
+        if (!is_chosen(label<F>)) return;
+        using T = std::remove_cv_t<std::remove_reference_t<
+                decltype(*begin(c))>>;
 
-        while (!empty(intervals)) {
-            std::tie(first, last) = intervals.top();
-            intervals.pop();
+        std::vector<Counted<T>> counted (begin(c), end(c));
 
-            if (detail::sorted_after_pivot_selection(first, last)) continue;
-            const auto mid = detail::partitions::hoare(first, last);
-            intervals.emplace(mid, last);
-            intervals.emplace(first, mid);
-        }
+        operation_counts = {};
+        f(begin(counted), end(counted));
+        const auto count = operation_counts.comparisons;
+
+        std::cout << label<F> << ": " << count << " comparisons\n";
     }
 
-    template<typename It>
-    void stdlib_heapsort(const It first, const It last)
+    // Prints the number of comparisons made by algorithms suited to expensive
+    // comparisons, beside the information-theoretic minimum, ceil(lg(n!)).
+    // Only those whose labels satisfy is_chosen are run.
+    template<typename C, typename P>
+    void test_comparison_counts(const C& c, const P is_chosen)
     {
-        std::make_heap(first, last);
-        std::sort_heap(first, last);
+        if (!is_chosen(label<decltype(merge_insertion_sort_f)>)
+                && !is_chosen(label<decltype(binary_insertion_sort_f)>)
+                && !is_chosen(label<decltype(mergesort_topdown_f)>)
+                && !is_chosen(label<decltype(stdlib_introsort_f)>))
+            return;
+
+        const auto len = static_cast<double>(size(c));
+        const auto bound = static_cast<std::uintmax_t>(
+                std::ceil(std::lgamma(len + 1.0) / std::log(2.0)));
+
+        std::cout << "Comparisons (at least " << bound
+                  << " needed in the worst case):\n";
+
+        count_one(c, merge_insertion_sort_f, is_chosen);
+        count_one(c, binary_insertion_sort_f, is_chosen);
+        count_one(c, mergesort_topdown_f, is_chosen);
+        count_one(c, stdlib_introsort_f, is_chosen);
     }
 
-    namespace detail {
-        template<typename It>
-        using ValueType = typename std::iterator_traits<It>::value_type;
+    // McIlroy's adversary ("A Killer Adversary for Quicksort", 1999), which
+    // builds an input on which a comparison sort does badly by answering its
+    // comparisons as it runs. Elements start as gas, greater than all other
+    // values. When two gas elements are compared, one is frozen to the next
+    // smallest value: the other, unless it is the candidate, the last gas
+    // element compared, which is likely a pivot. Sorting the frozen values
+    // again makes the same comparisons.
+    namespace adversary {
+        struct State {
+            std::vector<int> values;    // of each element, or gas
+            int gas;                    // greater than every frozen value
+            int frozen;                 // how many elements are frozen
+            std::size_t candidate;      // the last gas element compared
+            std::size_t comparisons;
+            std::chrono::steady_clock::time_point deadline;
+            bool gave_up;               // froze everything at the deadline
+        };
 
-        template<typename It>
-        constexpr auto accurate_value_type_v = std::is_same_v<
-                ValueType<It>,
-                std::remove_reference_t<decltype(*std::declval<It>())>>;
+        State state {};
 
-        template<typename It>
-        using ValueTypeVector = std::vector<ValueType<It>>;
+        // Freezes the remaining gas elements in order.
+        void freeze_all()
+        {
+            for (auto& value : state.values)
+                if (value == state.gas) value = state.frozen++;
+        }
 
-        template<typename It>
-        constexpr auto known_vector_iterator_v =
-            std::is_same_v<It, typename ValueTypeVector<It>::const_iterator>
-                || std::is_same_v<It, typename ValueTypeVector<It>::iterator>;
+        // Compares two elements by index, freezing as described above. Past
+        // the deadline, freezes everything, so the sort finishes quickly.
+        bool less(const std::size_t x, const std::size_t y)
+        {
+            auto& s = state;
 
-        template<typename It>
-        constexpr auto known_contiguous_v =
-            std::is_pointer_v<It> || known_vector_iterator_v<It>;
-    }
+            if (++s.comparisons % 4096 == 0 && !s.gave_up
+                    && std::chrono::steady_clock::now() > s.deadline) {
+                freeze_all();
+                s.gave_up = true;
+            }
 
-    template<typename It>
-    void stdlib_qsort(const It first, const It last)
-    {
-        static_assert(detail::accurate_value_type_v<It>,
-                "iterator appears not to report its value type correctly");
-        static_assert(detail::known_contiguous_v<It>,
-                "iterator type not in the short known-contiguous whitelist");
-        static_assert(!std::is_const_v<detail::ValueType<It>>,
-                "can't safely sort a range using iterators to const");
-        static_assert(std::is_trivial_v<detail::ValueType<It>>,
-                "can't safely std::qsort elements not satisfying TrivialType");
+            if (s.values[x] == s.gas && s.values[y] == s.gas)
+                s.values[x == s.candidate ? x : y] = s.frozen++;
 
-        const auto len = last - first;
-        assert(len >= 0);
-        if (len == 0) return;
+            if (s.values[x] == s.gas)
+                s.candidate = x;
+            else if (s.values[y] == s.gas)
+                s.candidate = y;
 
-        std::qsort(std::addressof(*first), static_cast<std::size_t>(len),
-                   sizeof *first, [](const void* const p, const void* const q) {
-            const auto& lhs = *static_cast<const detail::ValueType<It>*>(p);
-            const auto& rhs = *static_cast<const detail::ValueType<It>*>(q);
+            return s.values[x] < s.values[y];
+        }
 
-            if (lhs < rhs) return -1;
-            if (rhs < lhs) return +1;
-            return 0;
-        });
-    }
+        // An element of the input being built, named by its position in it.
+        // It is trivial, so std::qsort can sort it.
+        class Element {
+        public:
+            Element() = default;
 
-    template<typename T>
-    constexpr auto label = label<const T>;
+            explicit Element(const std::size_t index) : index_{index} { }
 
-    template<typename T>
-    constexpr auto label<const T> = ""sv;
+            friend bool operator<(const Element& lhs, const Element& rhs)
+            {
+                return less(lhs.index_, rhs.index_);
+            }
 
-    constexpr auto insertion_sort_f = [](const auto first, const auto last) {
-        insertion_sort(first, last);
-    };
+        private:
+            std::size_t index_;
+        };
 
-    template<>
-    constexpr auto label<decltype(insertion_sort_f)> = "Insertion sort"sv;
+        // Builds the keys of an input of len elements against an algorithm,
+        // or nothing if the algorithm was still sorting at the deadline.
+        std::optional<std::vector<int>>
+        attack(const Algorithm<Element>& algorithm, const std::size_t len,
+               const std::chrono::steady_clock::time_point deadline)
+        {
+            const auto gas = static_cast<int>(len);
+            state = {std::vector<int>(len, gas), gas, 0, 0, 0, deadline, false};
 
-    constexpr auto insertion_sort_byswap_f = [](const auto first,
-                                                const auto last) {
-        insertion_sort_byswap(first, last);
-    };
+            std::vector<Element> elements;
+            elements.reserve(len);
+            for (std::size_t i = 0; i != len; ++i) elements.emplace_back(i);
 
-    template<>
-    constexpr auto label<decltype(insertion_sort_byswap_f)> =
-            "Insertion sort (swapping)"sv;
+            algorithm.sort(data(elements), data(elements) + size(elements));
+            if (state.gave_up) return std::nullopt;
 
-    constexpr auto binary_insertion_sort_f = [](const auto first,
-                                                const auto last) {
-        binary_insertion_sort(first, last);
-    };
+            freeze_all();
+            return std::move(state.values);
+        }
+    }
 
-    template<>
-    constexpr auto label<decltype(binary_insertion_sort_f)> =
-            "Binary insertion sort"sv;
+    constexpr char to_lower(const char c) noexcept
+    {
+        return 'A' <= c && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
 
-    constexpr auto binary_insertion_sort_byrotate_f = [](const auto first,
-                                                         const auto last) {
-        binary_insertion_sort_byrotate(first, last);
-    };
+    // Case-insensitively matches text against a glob pattern, in which * is
+    // any run of characters and ? is any one character.
+    bool glob_match(const std::string_view pattern, const std::string_view text)
+    {
+        std::size_t p {0}, t {0};
+        auto star = std::string_view::npos;
+        std::size_t resume {0};
+
+        while (t != text.size()) {
+            if (p != pattern.size() && (pattern[p] == '?'
+                        || to_lower(pattern[p]) == to_lower(text[t]))) {
+                ++p;
+                ++t;
+            } else if (p != pattern.size() && pattern[p] == '*') {
+                star = p++;
+                resume = t;
+            } else if (star != std::string_view::npos) {
+                p = star + 1;
+                t = ++resume;
+            } else {
+                return false;
+            }
+        }
 
-    template<>
-    constexpr auto label<decltype(binary_insertion_sort_byrotate_f)> =
-            "Binary insertion sort (rotating)"sv;
+        while (p != pattern.size() && pattern[p] == '*') ++p;
+        return p == pattern.size();
+    }
 
-    constexpr auto selection_sort_f = [](const auto first, const auto last) {
-        selection_sort(first, last);
+    // A pattern given with -a/--algo: a glob, or an ECMAScript regular
+    // expression between slashes that need only match part of the name or
+    // label. Both ignore case.
+    struct AlgorithmPattern {
+        std::string_view glob;
+        std::optional<std::regex> regex;
     };
 
-    template<>
-    constexpr auto label<decltype(selection_sort_f)> = "Selection sort"sv;
+    // Parses a pattern, compiling it if it is a regular expression. Returns
+    // nothing if the regular expression is malformed.
+    std::optional<AlgorithmPattern>
+    parse_algorithm_pattern(const std::string_view pattern)
+    {
+        if (pattern.size() < 2 || pattern.front() != '/'
+                               || pattern.back() != '/')
+            return AlgorithmPattern{pattern, std::nullopt};
+
+        try {
+            return AlgorithmPattern{
+                    pattern,
+                    std::regex{std::string{pattern.substr(1,
+                                                          pattern.size() - 2)},
+                               std::regex::ECMAScript | std::regex::icase}};
+        } catch (const std::regex_error&) {
+            return std::nullopt;
+        }
+    }
 
-    constexpr auto bubble_sort_f = [](const auto first, const auto last) {
-        bubble_sort(first, last);
-    };
+    // Checks if an algorithm's name or label matches a pattern.
+    bool algorithm_matches(const AlgorithmPattern& pattern,
+                           const std::string_view name,
+                           const std::string_view label)
+    {
+        if (const auto& re = pattern.regex) {
+            return std::regex_search(cbegin(name), cend(name), *re)
+                    || std::regex_search(cbegin(label), cend(label), *re);
+        }
 
-    template<>
-    constexpr auto label<decltype(bubble_sort_f)> = "Bubble sort (classic)"sv;
+        return glob_match(pattern.glob, name)
+                || glob_match(pattern.glob, label);
+    }
 
-    constexpr auto bubble_sort_nonadaptive_f = [](const auto first,
-                                                  const auto last) {
-        bubble_sort_nonadaptive(first, last);
+    // How results are written to standard output.
+    enum class Format {
+        text,   // human-readable lines, with examples and comparison counts
+        csv,    // a header, then one row per timed run
+        json,   // an array with one object per timed run
     };
 
-    template<>
-    constexpr auto label<decltype(bubble_sort_nonadaptive_f)> =
-            "Bubble sort (non-adaptive)"sv;
-
-    constexpr auto bubble_sort_maxadaptive_f = [](const auto first,
-                                                  const auto last) {
-        bubble_sort_maxadaptive(first, last);
+    // The order in which algorithms run on each input.
+    enum class Order {
+        fixed,      // the registry's, each algorithm's runs together
+        random,     // shuffled for each input, each's runs together
+        interleave, // one run of each at a time, shuffled for each round
     };
 
-    template<>
-    constexpr auto label<decltype(bubble_sort_maxadaptive_f)> =
-            "Bubble sort (fully adaptive)"sv;
+    // The first line of a file, if it can be read.
+    std::optional<std::string> read_first_line(const std::string& path)
+    {
+        std::ifstream in {path};
+        std::string line;
+        if (!std::getline(in, line)) return std::nullopt;
+        return line;
+    }
 
-    constexpr auto gnome_sort_f = [](const auto first, const auto last) {
-        gnome_sort(first, last);
-    };
+    // The CPU's model name, if /proc/cpuinfo gives it.
+    std::string get_cpu_model()
+    {
+        std::ifstream in {"/proc/cpuinfo"};
 
-    template<>
-    constexpr auto label<decltype(gnome_sort_f)> = "Gnome sort"sv;
+        for (std::string line; std::getline(in, line); ) {
+            if (line.rfind("model name", 0) != 0) continue;
 
-    constexpr auto shellsort_hibbard_f = [](const auto first, const auto last) {
-        shellsort_hibbard(first, last);
-    };
+            const auto colon = line.find(':');
+            if (colon == std::string::npos) break;
+            const auto start = line.find_first_not_of(' ', colon + 1);
+            return start == std::string::npos ? "" : line.substr(start);
+        }
 
-    template<>
-    constexpr auto label<decltype(shellsort_hibbard_f)> =
-            "Shellsort (Hibbard gap sequence)"sv;
+        return "unknown";
+    }
 
-    constexpr auto shellsort_3smooth_f = [](const auto first, const auto last) {
-        shellsort_3smooth(first, last);
+    // A CPU cache, as reported under /sys/devices/system/cpu/cpu0/cache.
+    struct Cache {
+        int level;
+        std::string type; // Data, Instruction, or Unified
+        std::size_t bytes;
     };
 
-    template<>
-    constexpr auto label<decltype(shellsort_3smooth_f)> =
-            "Shellsort (3-smooth gap sequence)"sv;
+    // The caches of the first CPU, from smallest level to largest.
+    std::vector<Cache> get_caches()
+    {
+        static const std::string dir {"/sys/devices/system/cpu/cpu0/cache"};
+        std::vector<Cache> caches;
+
+        for (auto i = 0; ; ++i) {
+            const auto index = dir + "/index" + std::to_string(i) + "/";
+            const auto level = read_first_line(index + "level");
+            const auto type = read_first_line(index + "type");
+            const auto size = read_first_line(index + "size");
+            if (!level || !type || !size) break;
+
+            const auto lv = parse_number<int>(*level);
+            auto text = std::string_view{*size};
+            auto scale = std::size_t{1};
+            if (!text.empty() && text.back() == 'K') scale = 1024;
+            if (!text.empty() && text.back() == 'M') scale = 1024 * 1024;
+            if (scale != 1) text.remove_suffix(1);
+            const auto count = parse_number<std::size_t>(text);
+
+            if (lv && count) caches.push_back({*lv, *type, *count * scale});
+        }
 
-    constexpr auto shellsort_sedgewick_f = [](const auto first,
-                                              const auto last) {
-        shellsort_sedgewick(first, last);
-    };
+        return caches;
+    }
 
-    template<>
-    constexpr auto label<decltype(shellsort_sedgewick_f)> =
-            "Shellsort (Sedgewick gap sequence)"sv;
+    // Names a cache briefly, e.g. "L1d 48K".
+    std::string cache_name(const Cache& cache)
+    {
+        auto text = "L" + std::to_string(cache.level);
+        if (cache.type == "Data") text += 'd';
+        if (cache.type == "Instruction") text += 'i';
+        return text + ' ' + std::to_string(cache.bytes / 1024) + 'K';
+    }
 
-    constexpr auto shellsort_tokuda_f = [](const auto first, const auto last) {
-        shellsort_tokuda(first, last);
-    };
+    // Describes caches briefly, e.g. "L1d 48K, L1i 32K, L2 2048K".
+    std::string describe_caches(const std::vector<Cache>& caches)
+    {
+        std::string text;
 
-    template<>
-    constexpr auto label<decltype(shellsort_tokuda_f)> =
-            "Shellsort (Tokuda gap sequence)"sv;
+        for (const auto& cache : caches) {
+            if (!text.empty()) text += ", ";
+            text += cache_name(cache);
+        }
 
-    constexpr auto shellsort_quasi_ciura_f = [](const auto first,
-                                                const auto last) {
-        shellsort_quasi_ciura(first, last);
-    };
+        return text.empty() ? "unknown" : text;
+    }
 
-    template<>
-    constexpr auto label<decltype(shellsort_quasi_ciura_f)> =
-            "Shellsort (Extended Ciura gap sequence)"sv;
+    // The sizes --sweep tests for elements of element_size bytes (not
+    // counting memory they own): just below and above the capacity of each
+    // data or unified cache, and doubling from a quarter of the smallest to
+    // 16 times the largest, in main memory. Without cache sizes, doubles
+    // from 1024 to 64M.
+    std::vector<std::size_t> sweep_sizes(const std::vector<Cache>& caches,
+                                         const std::size_t element_size)
+    {
+        std::vector<std::size_t> sizes;
+        auto smallest = std::numeric_limits<std::size_t>::max();
+        std::size_t largest {};
+
+        for (const auto& cache : caches) {
+            if (cache.type == "Instruction") continue;
+            const auto capacity = cache.bytes / element_size;
+            sizes.push_back(capacity * 4 / 5);
+            sizes.push_back(capacity * 5 / 4);
+            smallest = std::min(smallest, capacity);
+            largest = std::max(largest, capacity);
+        }
 
-    constexpr auto mergesort_topdown_f = [](const auto first, const auto last) {
-        mergesort_topdown(first, last);
+        const auto first = (largest != 0 ? std::max(smallest / 4,
+                                                    std::size_t{2})
+                                         : std::size_t{1024});
+        const auto last = (largest != 0 ? largest * 16 : std::size_t{1} << 26);
+        for (auto len = first; len <= last; len *= 2) sizes.push_back(len);
+
+        std::sort(begin(sizes), end(sizes));
+        sizes.erase(std::unique(begin(sizes), end(sizes)), end(sizes));
+        sizes.erase(begin(sizes), std::upper_bound(begin(sizes), end(sizes),
+                                                   std::size_t{1}));
+        return sizes;
+    }
+
+    // Median times fitted to t = a n^b lg n, with the standard error of b.
+    // The power of lg n is fixed, as fitting it too is ill-conditioned: over
+    // the sizes a run tests, n^b and lg(n)^c are nearly interchangeable.
+    struct ScalingFit {
+        double a;
+        double b;
+        double b_error;
     };
 
-    template<>
-    constexpr auto label<decltype(mergesort_topdown_f)> =
-            "Mergesort (top-down, recursive)"sv;
+    // Fits median times on four or more sizes by least squares on their
+    // logarithms: ln(t / lg n) = ln a + b ln n.
+    std::optional<ScalingFit>
+    fit_scaling(const std::vector<std::tuple<std::size_t, double>>& history)
+    {
+        std::vector<std::array<double, 2>> points; // (ln n, ln(t / lg n))
 
-    constexpr auto mergesort_topdown_iterative_f = [](const auto first,
-                                                      const auto last) {
-        mergesort_topdown_iterative(first, last);
-    };
+        for (const auto& [n, t] : history) {
+            if (n < 4 || t <= 0.0) continue;
 
-    template<>
-    constexpr auto label<decltype(mergesort_topdown_iterative_f)> =
-            "Mergesort (top-down, iterative)"sv;
+            const auto len = static_cast<double>(n);
+            points.push_back({std::log(len), std::log(t / std::log2(len))});
+        }
 
-    constexpr auto mergesort_bottomup_iterative_f = [](const auto first,
-                                                       const auto last) {
-        mergesort_bottomup_iterative(first, last);
-    };
+        if (size(points) < 4) return std::nullopt;
 
-    template<>
-    constexpr auto label<decltype(mergesort_bottomup_iterative_f)> =
-            "Mergesort (bottom-up, iterative)"sv;
+        const auto count = static_cast<double>(size(points));
+        auto mean_x = 0.0, mean_y = 0.0;
+        for (const auto& [x, y] : points) {
+            mean_x += x / count;
+            mean_y += y / count;
+        }
 
-    constexpr auto heapsort_f = [](const auto first, const auto last) {
-        heapsort(first, last);
-    };
+        auto sxx = 0.0, sxy = 0.0;
+        for (const auto& [x, y] : points) {
+            sxx += (x - mean_x) * (x - mean_x);
+            sxy += (x - mean_x) * (y - mean_y);
+        }
+        if (!(sxx > 0.0)) return std::nullopt;
 
-    template<>
-    constexpr auto label<decltype(heapsort_f)> = "Heapsort"sv;
+        const auto b = sxy / sxx;
+        const auto ln_a = mean_y - b * mean_x;
 
-    constexpr auto heapsort_byswap_f = [](const auto first, const auto last) {
-        heapsort_byswap(first, last);
-    };
+        auto ssr = 0.0;
+        for (const auto& [x, y] : points) {
+            const auto residual = y - (ln_a + b * x);
+            ssr += residual * residual;
+        }
+        const auto b_error = std::sqrt(ssr / (count - 2.0) / sxx);
 
-    template<>
-    constexpr auto label<decltype(heapsort_byswap_f)> = "Heapsort (swapping)"sv;
+        if (!std::isfinite(b) || !std::isfinite(ln_a)
+                || !std::isfinite(b_error))
+            return std::nullopt;
 
-    constexpr auto quicksort_lomuto_simple_f = [](const auto first,
-                                                  const auto last) {
-        quicksort_lomuto_simple(first, last);
-    };
+        return ScalingFit{std::exp(ln_a), b, b_error};
+    }
 
-    template<>
-    constexpr auto label<decltype(quicksort_lomuto_simple_f)> =
-            "Quicksort "
-            "(Lomuto partitioning, middle-element pivot, recursive)"sv;
+    // Prints how an algorithm's median times scaled: their fit, and each
+    // step between sizes where the time per n lg n rose by a quarter or
+    // more, naming the caches whose capacity the step crossed.
+    void print_scaling(std::ostream& out, const std::string_view label,
+                       std::vector<std::tuple<std::size_t, double>> history,
+                       const std::vector<Cache>& caches,
+                       const std::size_t element_size)
+    {
+        constexpr auto jump_ratio = 1.25;
 
-    constexpr auto quicksort_lomuto_simple_iterative_f = [](const auto first,
-                                                            const auto last) {
-        quicksort_lomuto_simple_iterative(first, last);
-    };
+        out << "  " << label << ':';
 
-    template<>
-    constexpr auto label<decltype(quicksort_lomuto_simple_iterative_f)> =
-            "Quicksort "
-            "(Lomuto partitioning, middle-element pivot, iterative)"sv;
+        if (const auto fit = fit_scaling(history))
+            out << " b = " << fit->b << " +/- " << fit->b_error;
+        else
+            out << " too few sizes to fit";
 
-    constexpr auto quicksort_lomuto_f = [](const auto first, const auto last) {
-        quicksort_lomuto(first, last);
-    };
+        std::sort(begin(history), end(history));
 
-    template<>
-    constexpr auto label<decltype(quicksort_lomuto_f)> =
-            "Quicksort "
-            "(Lomuto partitioning, median-of-three pivot, recursive)"sv;
+        const auto cost = [](const std::size_t n, const double t) {
+            const auto len = static_cast<double>(n);
+            return n < 2 ? 0.0 : t / (len * std::log2(len));
+        };
 
-    constexpr auto quicksort_lomuto_iterative_f = [](const auto first,
-                                                     const auto last) {
-        quicksort_lomuto_iterative(first, last);
-    };
+        for (std::size_t i = 1; i < size(history); ++i) {
+            const auto [n1, t1] = history[i - 1];
+            const auto [n2, t2] = history[i];
+            const auto c1 = cost(n1, t1), c2 = cost(n2, t2);
+            if (c1 <= 0.0 || c2 < c1 * jump_ratio) continue;
+
+            out << "; " << c2 / c1 << "x ns/nlgn from " << n1 << " to " << n2;
+
+            std::string crossed;
+            for (const auto& cache : caches) {
+                if (cache.type == "Instruction"
+                        || cache.bytes <= n1 * element_size
+                        || cache.bytes > n2 * element_size)
+                    continue;
+                if (!crossed.empty()) crossed += ", ";
+                crossed += cache_name(cache);
+            }
+            if (!crossed.empty()) out << " (past " << crossed << ')';
+        }
 
-    template<>
-    constexpr auto label<decltype(quicksort_lomuto_iterative_f)> =
-            "Quicksort "
-            "(Lomuto partitioning, median-of-three pivot, iterative)"sv;
+        out << '\n';
+    }
 
-    constexpr auto quicksort_hoare_f = [](const auto first, const auto last) {
-        quicksort_hoare(first, last);
-    };
+    // Checks that --huge-pages can work, warning if it can't.
+    void report_huge_pages()
+    {
+#ifdef __linux__
+        const auto mode =
+                read_first_line("/sys/kernel/mm/transparent_hugepage/enabled");
+        if (!mode || mode->find("[never]") != std::string::npos) {
+            std::cerr << "warning: transparent huge pages are unavailable;"
+                         " large blocks are only prefaulted\n";
+        }
+#else
+        std::cerr << "warning: --huge-pages is only supported on Linux\n";
+#endif
+    }
+
+    // Pins this process, and the children it forks, to a CPU. Returns
+    // whether it could.
+    bool pin_to_cpu([[maybe_unused]] const unsigned cpu)
+    {
+#ifdef __linux__
+        if (cpu >= CPU_SETSIZE) return false;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof set, &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    // The fraction of the time each CPU was busy over an interval, from
+    // /proc/stat, or empty if it can't be read.
+    std::map<unsigned, double>
+    cpu_busy_fractions(const std::chrono::milliseconds interval)
+    {
+        using Jiffies = std::map<unsigned, std::tuple<double, double>>;
+
+        // Total and idle (including waiting for I/O) time of each CPU.
+        const auto read_jiffies = [] {
+            Jiffies jiffies;
+            std::ifstream in {"/proc/stat"};
+
+            for (std::string line; std::getline(in, line); ) {
+                std::istringstream fields {line};
+                std::string name;
+                fields >> name;
+                if (name.rfind("cpu", 0) != 0 || size(name) == 3) continue;
+
+                const auto cpu = parse_number<unsigned>(
+                        std::string_view{name}.substr(3));
+                if (!cpu) continue;
+
+                auto total = 0.0, idle = 0.0;
+                auto j = 0.0;
+                for (auto k = 0; fields >> j; ++k) {
+                    total += j;
+                    if (k == 3 || k == 4) idle += j;
+                }
+                jiffies[*cpu] = {total, idle};
+            }
+
+            return jiffies;
+        };
 
-    template<>
-    constexpr auto label<decltype(quicksort_hoare_f)> =
-            "Quicksort "
-            "(Hoare partitioning, median-of-three pivot, recursive)"sv;
+        const auto before = read_jiffies();
+        std::this_thread::sleep_for(interval);
+        const auto after = read_jiffies();
+
+        std::map<unsigned, double> busy;
+        for (const auto& [cpu, times] : after) {
+            const auto p = before.find(cpu);
+            if (p == cend(before)) continue;
+
+            const auto total = std::get<0>(times) - std::get<0>(p->second);
+            const auto idle = std::get<1>(times) - std::get<1>(p->second);
+            if (total > 0.0) busy[cpu] = (total - idle) / total;
+        }
+
+        return busy;
+    }
+
+    // Parses a list of CPUs like "0-3,8", as in sysfs.
+    std::optional<std::vector<unsigned>>
+    parse_cpu_list(const std::string_view list)
+    {
+        std::vector<unsigned> cpus;
+
+        for (const auto item : split(list)) {
+            const auto dash = item.find('-');
+            const auto first = parse_number<unsigned>(item.substr(0, dash));
+            const auto last = (dash == std::string_view::npos ? first
+                    : parse_number<unsigned>(item.substr(dash + 1)));
+            if (!first || !last || *last < *first) return std::nullopt;
+
+            for (auto cpu = *first; cpu <= *last; ++cpu) cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
 
-    constexpr auto quicksort_hoare_iterative_f = [](const auto first,
-                                                    const auto last) {
-        quicksort_hoare_iterative(first, last);
+    // Warns about what makes timings on a CPU drift: a frequency governor
+    // other than performance, and busy SMT siblings sharing its core.
+    void check_cpu(const unsigned cpu)
+    {
+        constexpr auto busy_threshold = 0.1;
+
+        const auto dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+
+        const auto governor = read_first_line(dir
+                                              + "/cpufreq/scaling_governor");
+        if (governor && *governor != "performance") {
+            std::cerr << "warning: CPU " << cpu << "'s frequency governor is "
+                      << *governor << ", not performance, so its clock"
+                         " speed may vary\n";
+        }
+
+        const auto list = read_first_line(dir
+                                          + "/topology/thread_siblings_list");
+        const auto siblings = (list ? parse_cpu_list(*list) : std::nullopt);
+        if (!siblings || size(*siblings) < 2) return;
+
+        const auto busy = cpu_busy_fractions(std::chrono::milliseconds{100});
+        for (const auto sibling : *siblings) {
+            const auto p = busy.find(sibling);
+            if (sibling == cpu || p == cend(busy)
+                    || p->second < busy_threshold)
+                continue;
+
+            std::cerr << "warning: CPU " << sibling << ", an SMT sibling of"
+                         " CPU " << cpu << ", is " << p->second * 100.0
+                      << "% busy\n";
+        }
+    }
+
+    // Facts about the build and machine that results depend on.
+    struct Environment {
+        std::string compiler;
+        std::string flags;
+        std::string cpu_model;
+        unsigned cores;
+        std::string caches;
+        std::string git_revision;
+        std::uint64_t seed;
     };
 
-    template<>
-    constexpr auto label<decltype(quicksort_hoare_iterative_f)> =
-            "Quicksort "
-            "(Hoare partitioning, median-of-three pivot, iterative)"sv;
+    Environment get_environment(const std::uint64_t seed)
+    {
+#if defined(__clang__)
+        const std::string compiler {"clang " __clang_version__};
+#elif defined(__GNUC__)
+        const std::string compiler {"gcc " __VERSION__};
+#elif defined(_MSC_VER)
+        const auto compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+        const std::string compiler {"unknown"};
+#endif
+
+#ifdef SORTS_CXX_FLAGS
+        const std::string flags {SORTS_CXX_FLAGS};
+#else
+        const std::string flags {"unknown"};
+#endif
+
+#ifdef SORTS_GIT_REVISION
+        const std::string revision {SORTS_GIT_REVISION};
+#else
+        const std::string revision;
+#endif
+
+        return {compiler,
+                flags,
+                get_cpu_model(),
+                std::thread::hardware_concurrency(),
+                describe_caches(get_caches()),
+                revision.empty() ? "unknown" : revision,
+                seed};
+    }
+
+    // Writes a string as a JSON string literal.
+    void write_json_string(std::ostream& out, const std::string_view text)
+    {
+        out << '"';
+
+        for (const auto c : text) {
+            switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    constexpr auto hex = "0123456789abcdef"sv;
+                    out << "\\u00" << hex[static_cast<unsigned char>(c) >> 4]
+                        << hex[static_cast<unsigned char>(c) & 0xF];
+                } else {
+                    out << c;
+                }
+            }
+        }
+
+        out << '"';
+    }
+
+    // Writes a CSV field, quoting it if it needs to be quoted.
+    void write_csv_field(std::ostream& out, const std::string_view text)
+    {
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out << text;
+            return;
+        }
+
+        out << '"';
+        for (const auto c : text) {
+            if (c == '"') out << '"';
+            out << c;
+        }
+        out << '"';
+    }
+
+    // The fields of each machine-readable record, in order.
+    constexpr std::array record_fields {
+        "algorithm"sv, "label"sv, "type"sv, "distribution"sv, "size"sv,
+        "trial"sv, "time_ns"sv, "min_ns"sv, "median_ns"sv, "mean_ns"sv,
+        "stddev_ns"sv, "ci95_ns"sv, "trials"sv, "ok"sv, "stable"sv,
+        "compiler"sv,
+        "flags"sv, "cpu_model"sv, "cores"sv, "caches"sv, "git_revision"sv,
+        "seed"sv, "cycles"sv, "instructions"sv, "branch_misses"sv,
+        "l1d_misses"sv, "llc_misses"sv, "dtlb_misses"sv, "page_faults"sv,
+        "comparisons"sv, "copies"sv, "moves"sv, "swaps"sv,
+        "allocations"sv, "allocated_bytes"sv, "peak_bytes"sv,
+        "rss_delta_bytes"sv, "read_bandwidth"sv, "write_bandwidth"sv,
+        "copy_bandwidth"sv, "random_access_ns"sv, "copy_passes"sv,
+    };
 
-    constexpr auto stdlib_heapsort_f = [](const auto first, const auto last) {
-        stdlib_heapsort(first, last);
+    // Where an algorithm's measurement on one input fits in the matrix.
+    struct Cell {
+        std::string_view algorithm;
+        std::string_view label;
+        std::string_view type;
+        std::string_view distribution;
+        std::size_t size;
     };
 
-    template<>
-    constexpr auto label<decltype(stdlib_heapsort_f)> =
-            "std::make_heap + std::sort_heap (heapsort)"sv;
+    // Writes one CSV row or JSON object per timed run to standard output.
+    class RecordWriter {
+    public:
+        RecordWriter(Format format, Environment env);
+
+        RecordWriter(const RecordWriter&) = delete;
+        RecordWriter& operator=(const RecordWriter&) = delete;
+
+        ~RecordWriter();
 
-    constexpr auto stdlib_mergesort_f = [](const auto first, const auto last) {
-        std::stable_sort(first, last);
+        void write(const Cell& cell, const Measurement& m);
+
+    private:
+        Format format_;
+        Environment env_;
+        bool first_ {true};
     };
 
-    template<>
-    constexpr auto label<decltype(stdlib_mergesort_f)> =
-            "std::stable_sort (usually adaptive mergesort)"sv;
+    RecordWriter::RecordWriter(const Format format, Environment env)
+        : format_{format}, env_{std::move(env)}
+    {
+        if (format_ == Format::csv) {
+            for (const auto field : record_fields) {
+                if (field != record_fields.front()) std::cout << ',';
+                std::cout << field;
+            }
+            std::cout << '\n';
+        } else if (format_ == Format::json) {
+            std::cout << '[';
+        }
+    }
+
+    RecordWriter::~RecordWriter()
+    {
+        if (format_ == Format::json) std::cout << (first_ ? "]\n" : "\n]\n");
+    }
+
+    void RecordWriter::write(const Cell& cell, const Measurement& m)
+    {
+        if (format_ == Format::text) return;
+
+        const auto old_precision =
+                std::cout.precision(std::numeric_limits<double>::max_digits10);
+
+        // Fields are written in the order of record_fields.
+        for (std::size_t trial = 0; trial != size(m.times); ++trial) {
+            auto field = cbegin(record_fields);
+
+            const auto begin_field = [this, &field] {
+                if (format_ == Format::csv) {
+                    if (field != cbegin(record_fields)) std::cout << ',';
+                } else {
+                    std::cout << (field == cbegin(record_fields) ? "{" : ", ");
+                    write_json_string(std::cout, *field);
+                    std::cout << ": ";
+                }
+                ++field;
+            };
+
+            const auto put_text = [this, &begin_field](
+                                        const std::string_view text) {
+                begin_field();
+                if (format_ == Format::csv) write_csv_field(std::cout, text);
+                else write_json_string(std::cout, text);
+            };
+
+            const auto put_value = [&begin_field](const auto value) {
+                begin_field();
+                std::cout << value;
+            };
+
+            // Uncounted events are empty in CSV and null in JSON.
+            const auto put_count = [this, &begin_field](
+                                        const std::optional<double> count) {
+                begin_field();
+                if (count) std::cout << *count;
+                else if (format_ == Format::json) std::cout << "null";
+            };
+
+            if (format_ == Format::json) std::cout << (first_ ? "\n" : ",\n");
+            first_ = false;
+
+            put_text(cell.algorithm);
+            put_text(cell.label);
+            put_text(cell.type);
+            put_text(cell.distribution);
+            put_value(cell.size);
+            put_value(trial);
+            put_value(m.times[trial]);
+            put_value(m.summary.min);
+            put_value(m.summary.median);
+            put_value(m.summary.mean);
+            put_value(m.summary.stddev);
+            put_value(m.summary.ci95);
+            put_value(size(m.times));
+            put_value(m.ok ? "true"sv : "false"sv);
+            if (m.stable) put_value(*m.stable ? "true"sv : "false"sv);
+            else put_count(std::nullopt);
+            put_text(env_.compiler);
+            put_text(env_.flags);
+            put_text(env_.cpu_model);
+            put_value(env_.cores);
+            put_text(env_.caches);
+            put_text(env_.git_revision);
+            put_text(std::to_string(env_.seed)); // too big for some parsers
+            for (std::size_t i = 0; i != counters::event_count; ++i) {
+                put_count(empty(m.samples) ? std::nullopt
+                                           : m.samples[trial][i]);
+            }
+
+            // Operations are counted in a separate, untimed run.
+            const auto put_operations = [&](const auto member) {
+                if (m.operations)
+                    put_count(static_cast<double>((*m.operations).*member));
+                else
+                    put_count(std::nullopt);
+            };
+            put_operations(&OperationCounts::comparisons);
+            put_operations(&OperationCounts::copies);
+            put_operations(&OperationCounts::moves);
+            put_operations(&OperationCounts::swaps);
+
+            const auto& alloc = m.allocations[trial];
+            put_value(alloc.count);
+            put_value(alloc.bytes);
+            put_value(alloc.peak);
+            put_count(alloc.rss_delta);
+
+            // Bandwidth is measured separately, with --roofline.
+            const auto put_bandwidth = [&](const auto member) {
+                if (m.bounds) put_count(m.bounds->bandwidth.*member);
+                else put_count(std::nullopt);
+            };
+            put_bandwidth(&calibration::Bandwidth::read);
+            put_bandwidth(&calibration::Bandwidth::write);
+            put_bandwidth(&calibration::Bandwidth::copy);
+            put_bandwidth(&calibration::Bandwidth::latency);
+            if (m.bounds) put_count(m.times[trial] / m.bounds->pass);
+            else put_count(std::nullopt);
+
+            assert(field == cend(record_fields));
+            if (format_ == Format::csv) std::cout << '\n';
+            else std::cout << '}';
+        }
+
+        std::cout.precision(old_precision);
+    }
+
+    namespace json {
+        // A flat JSON object: its field names, and the text of their values.
+        using Record = std::vector<std::pair<std::string, std::string>>;
+
+        // Parses JSON text that is an array of flat objects, whose values
+        // are all strings, numbers, booleans, or null, as --format=json
+        // writes. Strings are unescaped; other values are kept as written.
+        class Parser {
+        public:
+            explicit Parser(const std::string_view text) noexcept
+                : text_{text} { }
+
+            std::optional<std::vector<Record>> parse_records();
+
+        private:
+            void skip_space() noexcept;
+            bool consume(char c) noexcept;
+            std::optional<std::string> parse_string();
+            std::optional<std::string> parse_scalar();
+            std::optional<Record> parse_object();
+
+            std::string_view text_;
+            std::size_t pos_ {0};
+        };
+
+        std::optional<std::vector<Record>> Parser::parse_records()
+        {
+            if (!consume('[')) return std::nullopt;
+
+            std::vector<Record> records;
 
-    constexpr auto stdlib_introsort_f = [](const auto first, const auto last) {
-        std::sort(first, last);
+            if (!consume(']')) {
+                do {
+                    auto record = parse_object();
+                    if (!record) return std::nullopt;
+                    records.push_back(std::move(*record));
+                } while (consume(','));
+
+                if (!consume(']')) return std::nullopt;
+            }
+
+            skip_space();
+            if (pos_ != size(text_)) return std::nullopt;
+            return records;
+        }
+
+        void Parser::skip_space() noexcept
+        {
+            while (pos_ != size(text_)
+                    && (text_[pos_] == ' ' || text_[pos_] == '\t'
+                        || text_[pos_] == '\n' || text_[pos_] == '\r'))
+                ++pos_;
+        }
+
+        bool Parser::consume(const char c) noexcept
+        {
+            skip_space();
+            if (pos_ == size(text_) || text_[pos_] != c) return false;
+            ++pos_;
+            return true;
+        }
+
+        // Appends a code point to a string as UTF-8.
+        void append_utf8(std::string& s, const std::uint32_t code)
+        {
+            const auto byte = [](const std::uint32_t bits) {
+                return static_cast<char>(static_cast<unsigned char>(bits));
+            };
+
+            if (code < 0x80) {
+                s += byte(code);
+            } else if (code < 0x800) {
+                s += byte(0xC0 | code >> 6);
+                s += byte(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                s += byte(0xE0 | code >> 12);
+                s += byte(0x80 | (code >> 6 & 0x3F));
+                s += byte(0x80 | (code & 0x3F));
+            } else {
+                s += byte(0xF0 | code >> 18);
+                s += byte(0x80 | (code >> 12 & 0x3F));
+                s += byte(0x80 | (code >> 6 & 0x3F));
+                s += byte(0x80 | (code & 0x3F));
+            }
+        }
+
+        std::optional<std::string> Parser::parse_string()
+        {
+            if (!consume('"')) return std::nullopt;
+
+            const auto hex4 = [this]() -> std::optional<std::uint32_t> {
+                if (size(text_) - pos_ < 4) return std::nullopt;
+                std::uint32_t code {};
+                const auto first = text_.data() + pos_;
+                const auto [p, ec] = std::from_chars(first, first + 4, code,
+                                                     16);
+                if (ec != std::errc{} || p != first + 4) return std::nullopt;
+                pos_ += 4;
+                return code;
+            };
+
+            std::string s;
+
+            while (pos_ != size(text_)) {
+                const auto c = text_[pos_++];
+                if (c == '"') return s;
+
+                if (c != '\\') {
+                    s += c;
+                    continue;
+                }
+
+                if (pos_ == size(text_)) break;
+
+                switch (const auto e = text_[pos_++]; e) {
+                case '"': case '\\': case '/':
+                    s += e;
+                    break;
+                case 'b':
+                    s += '\b';
+                    break;
+                case 'f':
+                    s += '\f';
+                    break;
+                case 'n':
+                    s += '\n';
+                    break;
+                case 'r':
+                    s += '\r';
+                    break;
+                case 't':
+                    s += '\t';
+                    break;
+                case 'u':
+                    if (auto code = hex4(); !code) {
+                        return std::nullopt;
+                    } else {
+                        if (0xD800 <= *code && *code < 0xDC00
+                                && text_.substr(pos_, 2) == "\\u"sv) {
+                            pos_ += 2;
+                            const auto low = hex4();
+                            if (!low || *low < 0xDC00 || *low >= 0xE000)
+                                return std::nullopt;
+                            *code = 0x10000 + ((*code - 0xD800) << 10)
+                                            + (*low - 0xDC00);
+                        }
+                        append_utf8(s, *code);
+                    }
+                    break;
+                default:
+                    return std::nullopt;
+                }
+            }
+
+            return std::nullopt; // unterminated
+        }
+
+        std::optional<std::string> Parser::parse_scalar()
+        {
+            skip_space();
+            if (pos_ == size(text_)) return std::nullopt;
+            if (text_[pos_] == '"') return parse_string();
+
+            constexpr auto scalar_chars = "0123456789+-.eEtruefalsn"sv;
+            const auto end = text_.find_first_not_of(scalar_chars, pos_);
+            const auto len = (end == std::string_view::npos
+                                ? size(text_) : end) - pos_;
+            if (len == 0) return std::nullopt;
+
+            std::string value {text_.substr(pos_, len)};
+            pos_ += len;
+            return value;
+        }
+
+        std::optional<Record> Parser::parse_object()
+        {
+            if (!consume('{')) return std::nullopt;
+
+            Record record;
+
+            if (!consume('}')) {
+                do {
+                    auto key = parse_string();
+                    if (!key || !consume(':')) return std::nullopt;
+                    auto value = parse_scalar();
+                    if (!value) return std::nullopt;
+                    record.emplace_back(std::move(*key), std::move(*value));
+                } while (consume(','));
+
+                if (!consume('}')) return std::nullopt;
+            }
+
+            return record;
+        }
+
+        // The value of a record's field, if it has the field.
+        std::optional<std::string_view> find_field(const Record& record,
+                                                   const std::string_view key)
+        {
+            for (const auto& [k, v] : record)
+                if (k == key) return std::string_view{v};
+
+            return std::nullopt;
+        }
+    }
+
+    // Identifies a cell by its algorithm, type, distribution, and size.
+    using CellKey = std::tuple<std::string, std::string, std::string,
+                               std::size_t>;
+
+    // Per-run times from an earlier --format=json run, to compare against.
+    struct Baseline {
+        std::map<CellKey, std::vector<double>> times;
+        std::optional<std::uint64_t> seed;
     };
 
-    template<>
-    constexpr auto label<decltype(stdlib_introsort_f)> =
-            "std::sort (usually introsort)"sv;
+    std::optional<Baseline> load_baseline(const std::string& path)
+    {
+        std::ifstream in {path};
+        if (!in) {
+            std::cerr << "error: can't read baseline " << path << '\n';
+            return std::nullopt;
+        }
+
+        const std::string text {std::istreambuf_iterator<char>{in},
+                                std::istreambuf_iterator<char>{}};
+
+        const auto records = json::Parser{text}.parse_records();
+        if (!records) {
+            std::cerr << "error: baseline " << path
+                      << " is not JSON written by --format=json\n";
+            return std::nullopt;
+        }
+
+        Baseline baseline;
+
+        for (const auto& record : *records) {
+            const auto algorithm = json::find_field(record, "algorithm");
+            const auto type = json::find_field(record, "type");
+            const auto dist = json::find_field(record, "distribution");
+            const auto len = json::find_field(record, "size");
+            const auto time = json::find_field(record, "time_ns");
+            const auto seed = json::find_field(record, "seed");
+
+            std::optional<std::size_t> size_value;
+            std::optional<double> time_value;
+            if (len) size_value = parse_number<std::size_t>(*len);
+            if (time) time_value = parse_number<double>(*time);
+
+            if (!algorithm || !type || !dist || !size_value || !time_value) {
+                std::cerr << "error: baseline " << path
+                          << " has a record without the needed fields\n";
+                return std::nullopt;
+            }
+
+            baseline.times[{std::string{*algorithm}, std::string{*type},
+                            std::string{*dist}, *size_value}]
+                    .push_back(*time_value);
+
+            if (seed && !baseline.seed)
+                baseline.seed = parse_number<std::uint64_t>(*seed);
+        }
+
+        return baseline;
+    }
+
+    // The two-sided p-value of the Mann-Whitney U test of whether xs and ys
+    // come from the same distribution. It is exact when there are no ties,
+    // and uses the normal approximation with a tie correction otherwise.
+    double mann_whitney_p(const std::vector<double>& xs,
+                          const std::vector<double>& ys)
+    {
+        const auto m = size(xs), n = size(ys);
+        assert(m != 0 && n != 0);
+
+        std::vector<std::tuple<double, bool>> all; // value, and if from xs
+        all.reserve(m + n);
+        for (const auto x : xs) all.emplace_back(x, true);
+        for (const auto y : ys) all.emplace_back(y, false);
+        std::sort(begin(all), end(all));
+
+        // Rank sum of xs, with ties given their mean rank.
+        auto rank_sum = 0.0, tie_sum = 0.0;
+        for (std::size_t i = 0; i != size(all); ) {
+            auto j = i + 1;
+            while (j != size(all) && std::get<0>(all[j]) == std::get<0>(all[i]))
+                ++j;
+
+            const auto mean_rank = static_cast<double>(i + j + 1) / 2.0;
+            for (auto k = i; k != j; ++k)
+                if (std::get<1>(all[k])) rank_sum += mean_rank;
+
+            const auto t = static_cast<double>(j - i);
+            tie_sum += t * t * t - t;
+            i = j;
+        }
+
+        const auto dm = static_cast<double>(m), dn = static_cast<double>(n);
+        const auto u = rank_sum - dm * (dm + 1.0) / 2.0;
+        const auto u_low = std::min(u, dm * dn - u);
+
+        if (tie_sum == 0.0) {
+            // The counts of arrangements with each U are the coefficients of
+            // the Gaussian binomial coefficient [m + n choose m] in q.
+            std::vector<double> counts (m * n + m + 1);
+            counts[0] = 1.0;
+            for (std::size_t i = 1; i <= m; ++i) {
+                for (auto k = size(counts) - 1; k >= n + i; --k)
+                    counts[k] -= counts[k - n - i]; // times 1 - q^(n + i)
+                for (auto k = i; k != size(counts); ++k)
+                    counts[k] += counts[k - i]; // over 1 - q^i
+            }
+
+            const auto total = std::accumulate(cbegin(counts),
+                                               cbegin(counts) + m * n + 1,
+                                               0.0);
+            const auto tail = std::accumulate(cbegin(counts),
+                    cbegin(counts) + static_cast<std::ptrdiff_t>(u_low) + 1,
+                    0.0);
+
+            return std::min(1.0, 2.0 * tail / total);
+        }
+
+        const auto total = dm + dn;
+        const auto variance = dm * dn / 12.0
+                * (total + 1.0 - tie_sum / (total * (total - 1.0)));
+        if (variance <= 0.0) return 1.0;
+
+        const auto z = (dm * dn / 2.0 - u_low - 0.5) / std::sqrt(variance);
+        return std::min(1.0, std::erfc(std::max(z, 0.0) / std::sqrt(2.0)));
+    }
+
+    // The smallest p-value mann_whitney_p can give for samples of sizes m
+    // and n without ties, when they don't overlap at all: 2 / C(m + n, m).
+    double min_mann_whitney_p(const std::size_t m, const std::size_t n)
+    {
+        auto arrangements = 1.0;
+        for (std::size_t i = 1; i <= m; ++i) {
+            arrangements = arrangements * static_cast<double>(n + i)
+                            / static_cast<double>(i);
+        }
+
+        return std::min(1.0, 2.0 / arrangements);
+    }
 
-    constexpr auto stdlib_qsort_f = [](const auto first, const auto last) {
-        stdlib_qsort(first, last);
+    // How a cell's times compare to the baseline's.
+    enum class Verdict {
+        same,           // no significant change at least the minimum effect
+        regression,
+        improvement,
     };
 
-    template<>
-    constexpr auto label<decltype(stdlib_qsort_f)> =
-            "std::qsort (often quicksort)"sv;
+    struct Comparison {
+        Cell cell;
+        double baseline_median;
+        double median;
+        double change; // relative to the baseline median
+        double p;
+        Verdict verdict;
+    };
 
-    template<typename C>
-    void print(const C& c, const std::string_view prefix = " ")
+    // Compares a measurement to the baseline's times for the same cell, if
+    // there are any. A change is reported if it is significant at level
+    // alpha and is at least min_effect, a fraction of the baseline median.
+    std::optional<Comparison> compare(const Baseline& baseline,
+                                      const Cell& cell, const Measurement& m,
+                                      const double alpha,
+                                      const double min_effect)
     {
-        std::cout << prefix << '[';
+        const auto p = baseline.times.find({std::string{cell.algorithm},
+                                            std::string{cell.type},
+                                            std::string{cell.distribution},
+                                            cell.size});
+        if (p == cend(baseline.times)) return std::nullopt;
+
+        const auto& base_times = p->second;
+        const auto base_median = summarize(base_times).median;
+        const auto change = (m.summary.median - base_median) / base_median;
+        const auto p_value = mann_whitney_p(base_times, m.times);
+
+        auto verdict = Verdict::same;
+        if (p_value < alpha && change >= min_effect)
+            verdict = Verdict::regression;
+        else if (p_value < alpha && change <= -min_effect)
+            verdict = Verdict::improvement;
+
+        return Comparison{cell, base_median, m.summary.median, change,
+                          p_value, verdict};
+    }
 
-        auto sep = "";
-        for (const auto& x : c) {
-            std::cout << sep << x;
-            sep = ", ";
+    // Prints a table of comparisons with the baseline, and a tally.
+    void print_comparisons(std::ostream& out,
+                           const std::vector<Comparison>& comparisons,
+                           const double alpha, const double min_effect)
+    {
+        out << "Comparison with baseline (Mann-Whitney U, alpha " << alpha
+            << ", minimum effect " << min_effect * 100.0 << "%):\n";
+
+        auto regressions = 0, improvements = 0;
+
+        for (const auto& c : comparisons) {
+            auto verdict = "same"sv;
+            if (c.verdict == Verdict::regression) {
+                verdict = "REGRESSION"sv;
+                ++regressions;
+            } else if (c.verdict == Verdict::improvement) {
+                verdict = "improvement"sv;
+                ++improvements;
+            }
+
+            out << std::left << std::setw(36) << c.cell.algorithm << ' '
+                << std::setw(11) << c.cell.type << ' '
+                << std::setw(13) << c.cell.distribution << ' '
+                << std::right << std::setw(9) << c.cell.size << "  "
+                << Nanoseconds{c.baseline_median} << " -> "
+                << Nanoseconds{c.median} << " ("
+                << (c.change >= 0.0 ? "+" : "") << c.change * 100.0
+                << "%, p = " << c.p << ") " << verdict << '\n';
         }
 
-        std::cout << ']';
+        out << size(comparisons) << " cells compared: " << regressions
+            << " regressions, " << improvements << " improvements.\n";
     }
 
-    template<typename C>
-    void print_if_small(const C& c, const std::string_view prefix = " ")
+    // Settings from the command line.
+    struct Options {
+        std::vector<AlgorithmPattern> algo_patterns; // all if empty
+        std::vector<std::size_t> sizes; // default sizes and examples if empty
+        std::vector<Distribution> dists;
+        std::vector<std::string_view> type_names;
+        Trials trials {1, 3};
+        double budget {10.0}; // in seconds, per run
+        std::optional<std::uint64_t> seed; // random if absent
+        std::optional<std::string_view> dump_prefix;
+        Format format {Format::text};
+        Order order {Order::fixed};
+        std::optional<unsigned> cpu; // to pin to, if any
+        bool count_events {false};
+        bool count_operations {false};
+        bool show_memory {false};
+        bool huge_pages {false};
+        bool roofline {false};
+        bool sweep {false};
+        std::optional<std::string_view> baseline_path;
+        double alpha {0.05};
+        double min_effect {0.05}; // as a fraction of the baseline median
+        bool skip_slowest {false};
+        bool list {false};
+        bool help {false};
+    };
+
+    void print_usage(const std::string_view program)
     {
-        static constexpr std::size_t print_threshold {20};
+        std::cout << "Usage: " << program << " [OPTION]...\n"
+R"(Benchmark sorting algorithms on inputs of various types and distributions.
+
+  -a, --algo PATTERN    run algorithms whose name or label matches PATTERN,
+                        a glob (* and ?) or a /regular expression/; may be
+                        given more than once (default: all)
+  -s, --size LIST       comma-separated sizes (with optional k, M, G suffix)
+                        and ranges FIRST..LAST[:xFACTOR|:+STEP]
+  -d, --dist LIST       comma-separated distributions, or all (the default)
+  -t, --type LIST       comma-separated element types, or all (the default)
+  -r, --reps N          timed trials per algorithm and input (default: 3)
+  -w, --warmups N       untimed runs before the trials (default: 1)
+  -b, --budget SECONDS  time allowed per run of an algorithm on an input
+                        (default: 10); runs predicted from smaller inputs to
+                        take longer are skipped, runs on an input are cut
+                        short after SECONDS per run plus one second, and a
+                        median over SECONDS skips larger inputs of the same
+                        type and distribution
+  -S, --skip-slowest    skip the quadratic sorts other than insertion sorts
+      --sweep           test sizes just below and above each cache's
+                        capacity and doubling into main memory (unless
+                        --size is given), and report each algorithm's fit
+                        to a n^b lg n and where its time per n lg n jumps
+      --seed N          generate inputs from seed N (default: random); each
+                        input depends only on N, its distribution, and size
+      --counters        count CPU events in each timed run (Linux only):
+                        cycles, instructions, branch, L1D, LLC, and dTLB
+                        misses, and page faults
+      --operations      also run each algorithm once on elements that count
+                        comparisons, copies, moves, and swaps, and report
+                        them per element
+      --memory          report the allocations, peak bytes allocated, and
+                        change in resident set size during each timed run
+      --cpu N           run on CPU N only, warning if its frequency governor
+                        isn't performance or its SMT siblings are busy
+      --order ORDER     run the algorithms on each input in a fixed order
+                        (the default), a random order, or interleave their
+                        trials in a random order per round
+      --roofline        measure memory bandwidth and random access latency
+                        over each input's size, and report each time as
+                        copies of the input and random accesses per element
+      --huge-pages      map blocks of 2 MiB or more with transparent huge
+                        pages and fault them in when allocated, reusing
+                        freed ones, so runs don't pay for page faults (Linux
+                        only); compare --counters with and without it
+      --format FORMAT   write results as text (the default), or as csv or
+                        json with one record per timed run
+      --baseline FILE   compare each cell's times with those in FILE, from
+                        an earlier run with --format=json, rerunning only its
+                        cells (and with its seed, unless --seed is given);
+                        exit with status 2 if any cell regressed; --reps
+                        is raised if needed so that a change can be
+                        significant (at --alpha 0.05, at least 4 trials
+                        against a 4-trial baseline, or 5 against 3)
+      --alpha A         significance level for --baseline (default: 0.05)
+      --min-effect PCT  smallest change in median time, as a percentage,
+                        that --baseline reports (default: 5)
+      --dump-input PREFIX
+                        write each generated input's keys, as raw ints in
+                        native byte order, to PREFIXDIST-SIZE.bin (or, for
+                        antiqsort, PREFIXantiqsort-ALGORITHM-SIZE.bin)
+  -l, --list            list the algorithms, types, and distributions
+  -h, --help            show this help
+)";
+    }
 
-        if (size(c) <= print_threshold) print(c, prefix);
+    void print_list()
+    {
+        std::cout << "Algorithms (name, group, stability, label):\n";
+        for (const auto& a : algorithms<int>()) {
+            std::cout << "  " << a.name << " [" << group_name(a.group)
+                      << (a.stable ? ", stable" : "") << "] " << a.label
+                      << '\n';
+        }
+
+        std::cout << "Element types:";
+        for_each_element_type([](const auto e) {
+            std::cout << ' ' << decltype(e)::name;
+        });
+
+        std::cout << "\nDistributions:";
+        for (const auto& d : all_distributions) std::cout << ' ' << d.name;
+        std::cout << '\n';
     }
 
-    template<typename C, typename F>
-    void test_one(C c, const F f)
+    // Looks up the distributions in a comma-separated list, or all of them.
+    std::optional<std::vector<Distribution>>
+    find_distributions(const std::string_view names)
     {
-        using namespace std::chrono;
-        using std::begin, std::end, std::cbegin, std::cend;
+        if (names == "all"sv) {
+            return std::vector<Distribution>(cbegin(all_distributions),
+                                             cend(all_distributions));
+        }
 
-        std::cout << label<F> << ':' << std::flush;
+        std::vector<Distribution> selected;
 
-        const auto ti = steady_clock::now();
-        f(begin(c), end(c));
-        const auto tf = steady_clock::now();
+        for (const auto name : split(names)) {
+            const auto p = std::find_if(cbegin(all_distributions),
+                                        cend(all_distributions),
+                                        [name](const Distribution& d) {
+                return d.name == name;
+            });
 
-        const auto dt = duration_cast<milliseconds>(tf - ti);
-        std::cout << ' ' << dt.count() << "ms";
+            if (p == cend(all_distributions)) {
+                std::cerr << "error: unknown distribution \"" << name
+                          << "\" (see --list)\n";
+                return std::nullopt;
+            }
 
-        print_if_small(c);
+            selected.push_back(*p);
+        }
 
-        const auto ok = std::is_sorted(cbegin(c), cend(c));
-        std::cout << ' ' << (ok ? "OK." : "FAIL!!!") << '\n';
+        return selected;
     }
 
-    template<typename C, typename... Fs>
-    void test_algorithms(const C& c, const Fs... fs)
+    // Checks the names in a comma-separated list of element types, or lists
+    // all of them.
+    std::optional<std::vector<std::string_view>>
+    find_element_types(const std::string_view names)
     {
-        (..., test_one(c, fs));
+        std::vector<std::string_view> known;
+        for_each_element_type([&known](const auto e) {
+            known.push_back(decltype(e)::name);
+        });
+
+        if (names == "all"sv) return known;
+
+        const auto selected = split(names);
+
+        for (const auto name : selected) {
+            if (std::find(cbegin(known), cend(known), name) == cend(known)) {
+                std::cerr << "error: unknown element type \"" << name
+                          << "\" (see --list)\n";
+                return std::nullopt;
+            }
+        }
+
+        return selected;
     }
 
-    template<typename C>
-    void test_insertion_sorts(const C& c)
+    // Parses the command line, reporting any errors. Options that take a
+    // value accept it as the next argument, or after = in the long form.
+    std::optional<Options> parse_options(const int argc,
+                                         const char* const* const argv)
     {
-        test_algorithms(c, insertion_sort_f,
-                           insertion_sort_byswap_f,
-                           binary_insertion_sort_f,
-                           binary_insertion_sort_byrotate_f);
+        Options opts;
+        auto dist_names = "all"sv, type_names = "all"sv;
+
+        for (auto i = 1; i < argc; ++i) {
+            std::string_view arg {argv[i]};
+            std::optional<std::string_view> attached;
+
+            if (const auto eq = arg.find('=');
+                    arg.substr(0, 2) == "--"sv
+                            && eq != std::string_view::npos) {
+                attached = arg.substr(eq + 1);
+                arg = arg.substr(0, eq);
+            }
+
+            const auto is = [arg](const std::string_view short_name,
+                                  const std::string_view long_name) {
+                return (!empty(short_name) && arg == short_name)
+                        || arg == long_name;
+            };
+
+            const auto takes_value = is("-a", "--algo") || is("-s", "--size")
+                    || is("-d", "--dist") || is("-t", "--type")
+                    || is("-r", "--reps") || is("-w", "--warmups")
+                    || is("-b", "--budget") || is("", "--seed")
+                    || is("", "--dump-input") || is("", "--format")
+                    || is("", "--baseline") || is("", "--alpha")
+                    || is("", "--min-effect") || is("", "--cpu")
+                    || is("", "--order");
+
+            auto value = ""sv;
+            if (takes_value) {
+                if (attached) {
+                    value = *attached;
+                } else if (i + 1 < argc) {
+                    value = argv[++i];
+                } else {
+                    std::cerr << "error: " << arg << " needs a value\n";
+                    return std::nullopt;
+                }
+            } else if (attached) {
+                std::cerr << "error: " << arg << " takes no value\n";
+                return std::nullopt;
+            }
+
+            const auto bad_value = [arg, value] {
+                std::cerr << "error: bad value for " << arg << ": \""
+                          << value << "\"\n";
+                return std::nullopt;
+            };
+
+            if (is("-h", "--help")) {
+                opts.help = true;
+            } else if (is("-l", "--list")) {
+                opts.list = true;
+            } else if (is("-S", "--skip-slowest")) {
+                opts.skip_slowest = true;
+            } else if (is("", "--counters")) {
+                opts.count_events = true;
+            } else if (is("", "--operations")) {
+                opts.count_operations = true;
+            } else if (is("", "--memory")) {
+                opts.show_memory = true;
+            } else if (is("", "--huge-pages")) {
+                opts.huge_pages = true;
+            } else if (is("", "--roofline")) {
+                opts.roofline = true;
+            } else if (is("", "--sweep")) {
+                opts.sweep = true;
+            } else if (is("-a", "--algo")) {
+                auto pattern = parse_algorithm_pattern(value);
+                if (!pattern) return bad_value();
+                opts.algo_patterns.push_back(std::move(*pattern));
+            } else if (is("-s", "--size")) {
+                const auto sizes = parse_sizes(value);
+                if (!sizes) return bad_value();
+                opts.sizes.insert(end(opts.sizes), cbegin(*sizes),
+                                  cend(*sizes));
+            } else if (is("-d", "--dist")) {
+                dist_names = value;
+            } else if (is("-t", "--type")) {
+                type_names = value;
+            } else if (is("-r", "--reps")) {
+                const auto reps = parse_number<int>(value);
+                if (!reps || *reps < 1) return bad_value();
+                opts.trials.timed = *reps;
+            } else if (is("-w", "--warmups")) {
+                const auto warmups = parse_number<int>(value);
+                if (!warmups || *warmups < 0) return bad_value();
+                opts.trials.warmups = *warmups;
+            } else if (is("-b", "--budget")) {
+                const auto budget = parse_number<double>(value);
+                if (!budget || !(*budget > 0.0)) return bad_value();
+                opts.budget = *budget;
+            } else if (is("", "--seed")) {
+                const auto seed = parse_number<std::uint64_t>(value);
+                if (!seed) return bad_value();
+                opts.seed = seed;
+            } else if (is("", "--dump-input")) {
+                opts.dump_prefix = value;
+            } else if (is("", "--format")) {
+                if (value == "text"sv) opts.format = Format::text;
+                else if (value == "csv"sv) opts.format = Format::csv;
+                else if (value == "json"sv) opts.format = Format::json;
+                else return bad_value();
+            } else if (is("", "--order")) {
+                if (value == "fixed"sv) opts.order = Order::fixed;
+                else if (value == "random"sv) opts.order = Order::random;
+                else if (value == "interleave"sv)
+                    opts.order = Order::interleave;
+                else return bad_value();
+            } else if (is("", "--cpu")) {
+                const auto cpu = parse_number<unsigned>(value);
+                if (!cpu) return bad_value();
+                opts.cpu = cpu;
+            } else if (is("", "--baseline")) {
+                opts.baseline_path = value;
+            } else if (is("", "--alpha")) {
+                const auto alpha = parse_number<double>(value);
+                if (!alpha || !(*alpha > 0.0 && *alpha < 1.0))
+                    return bad_value();
+                opts.alpha = *alpha;
+            } else if (is("", "--min-effect")) {
+                const auto percent = parse_number<double>(value);
+                if (!percent || !(*percent >= 0.0)) return bad_value();
+                opts.min_effect = *percent / 100.0;
+            } else {
+                std::cerr << "error: unknown option " << arg
+                          << " (see --help)\n";
+                return std::nullopt;
+            }
+        }
+
+        // Run sizes in increasing order, so budgets carry to larger inputs.
+        std::sort(begin(opts.sizes), end(opts.sizes));
+        opts.sizes.erase(std::unique(begin(opts.sizes), end(opts.sizes)),
+                         end(opts.sizes));
+
+        auto dists = find_distributions(dist_names);
+        auto types = find_element_types(type_names);
+        if (!dists || !types) return std::nullopt;
+        opts.dists = std::move(*dists);
+        opts.type_names = std::move(*types);
+
+        return opts;
     }
 
-    template<typename C>
-    void test_other_slow(const C& c)
+    // Sizes of inputs whose elements would take more space than this (not
+    // counting memory they own, such as long strings' buffers) are skipped.
+    constexpr std::size_t max_input_bytes = 100'000'000 * sizeof(int);
+
+    constexpr auto comparison_count_threshold = 100'000;
+
+    constexpr std::array<std::size_t, 9> default_sizes {
+        6,
+        1000,
+        10'000,
+        100'000,
+        250'000,
+        500'000,
+        1'000'000,
+        10'000'000,
+        100'000'000,
+        //1'000'000'000
+    };
+
+    // Writes the keys of a generated input to a file, as raw ints.
+    void dump_keys(const std::vector<int>& keys, const std::string_view prefix,
+                   const std::string_view name)
     {
-        test_algorithms(c, selection_sort_f,
-                           bubble_sort_f,
-                           bubble_sort_nonadaptive_f,
-                           bubble_sort_maxadaptive_f,
-                           gnome_sort_f);
+        auto path = std::string{prefix};
+        path.append(name).append("-").append(std::to_string(size(keys)))
+            .append(".bin");
+
+        std::ofstream out {path, std::ios::binary};
+        out.write(reinterpret_cast<const char*>(data(keys)),
+                  static_cast<std::streamsize>(size(keys) * sizeof(int)));
+
+        if (!out) std::cerr << "warning: can't write input to " << path << '\n';
     }
 
-    template<typename C>
-    void test_fast(const C& c)
-    {
-        test_algorithms(c, shellsort_hibbard_f,
-                           shellsort_3smooth_f,
-                           shellsort_sedgewick_f,
-                           shellsort_tokuda_f,
-                           shellsort_quasi_ciura_f,
-                           mergesort_topdown_f,
-                           mergesort_topdown_iterative_f,
-                           mergesort_bottomup_iterative_f,
-                           heapsort_f,
-                           heapsort_byswap_f,
-                           quicksort_lomuto_simple_f,
-                           quicksort_lomuto_simple_iterative_f,
-                           quicksort_lomuto_f,
-                           quicksort_lomuto_iterative_f,
-                           quicksort_hoare_f,
-                           quicksort_hoare_iterative_f,
-                           stdlib_heapsort_f,
-                           stdlib_mergesort_f,
-                           stdlib_introsort_f,
-                           stdlib_qsort_f);
-    }
-
-    bool will_do_slowest(const int argc, const char* const* const argv)
-    {
-        assert(argc > 0);
-
-        return std::none_of(argv + 1, argv + argc, [](const auto arg) noexcept {
-            return arg == "-S"sv || arg == "--skip-slowest"sv;
-        });
+    // Narrows the sizes, distributions, and element types to those that
+    // appear in a baseline, so its cells are rerun but nothing else is.
+    // Returns false if no cells are left.
+    bool restrict_to_baseline(Options& opts, const Baseline& baseline)
+    {
+        std::vector<std::size_t> sizes;
+        std::vector<std::string_view> dist_names, type_names;
+
+        for (const auto& [key, times] : baseline.times) {
+            const auto& [algorithm, type, dist, len] = key;
+            sizes.push_back(len);
+            dist_names.push_back(dist);
+            type_names.push_back(type);
+        }
+
+        const auto in = [](const auto& items, const auto& item) {
+            return std::find(cbegin(items), cend(items), item) != cend(items);
+        };
+
+        if (empty(opts.sizes)) opts.sizes = sizes;
+        opts.sizes.erase(std::remove_if(begin(opts.sizes), end(opts.sizes),
+                                        [&](const std::size_t len) {
+                             return !in(sizes, len);
+                         }),
+                         end(opts.sizes));
+        std::sort(begin(opts.sizes), end(opts.sizes));
+        opts.sizes.erase(std::unique(begin(opts.sizes), end(opts.sizes)),
+                         end(opts.sizes));
+
+        opts.dists.erase(std::remove_if(begin(opts.dists), end(opts.dists),
+                                        [&](const Distribution& d) {
+                             return !in(dist_names, d.name);
+                         }),
+                         end(opts.dists));
+
+        opts.type_names.erase(std::remove_if(begin(opts.type_names),
+                                             end(opts.type_names),
+                                             [&](const std::string_view t) {
+                                  return !in(type_names, t);
+                              }),
+                              end(opts.type_names));
+
+        return !empty(opts.sizes) && !empty(opts.dists)
+                                  && !empty(opts.type_names);
     }
 
-    auto make_generator()
+    // Raises the timed trials, if needed, so that a cell with the fewest
+    // trials in the baseline can differ significantly at level alpha.
+    // Otherwise no cell could be flagged, and every regression would pass.
+    // Returns false if no number of trials up to max_trials would do.
+    bool ensure_baseline_power(Options& opts, const Baseline& baseline)
     {
-        using Range = std::numeric_limits<int>;
-        using Dist = std::uniform_int_distribution<int>;
+        constexpr auto max_trials = 1000;
 
-        return [eng = std::mt19937{std::random_device{}()},
-                dist = Dist{Range::min(), Range::max()}](const std::size_t len)
-                mutable {
-            std::vector<int> a (len);
-            for (auto& x : a) x = dist(eng);
-            return a;
+        std::size_t base_trials {std::numeric_limits<std::size_t>::max()};
+        for (const auto& [key, times] : baseline.times)
+            base_trials = std::min(base_trials, size(times));
+
+        const auto reachable = [&](const int trials) {
+            return min_mann_whitney_p(base_trials,
+                                      static_cast<std::size_t>(trials))
+                    < opts.alpha;
         };
+
+        auto trials = opts.trials.timed;
+        while (!reachable(trials)) {
+            if (++trials > max_trials) {
+                std::cerr << "error: the baseline's cells with "
+                          << base_trials << " trials can't differ "
+                          << "significantly at alpha " << opts.alpha
+                          << " with up to " << max_trials << " trials\n";
+                return false;
+            }
+        }
+
+        if (trials != opts.trials.timed) {
+            std::cerr << "warning: raising --reps from " << opts.trials.timed
+                      << " to " << trials << ", the fewest that can differ"
+                      << " significantly at alpha " << opts.alpha
+                      << " from the baseline's " << base_trials
+                      << "-trial cells\n";
+            opts.trials.timed = trials;
+        }
+
+        return true;
     }
 
-    constexpr auto slow_threshold = 1'000'000;
+    // Runs the benchmark for one element type, as the options specify. If
+    // dump is true, the keys of generated inputs are written to files. If
+    // there is a baseline, only its cells are run, and they are compared.
+    template<typename E>
+    void test_element_type(const Options& opts, const std::uint64_t seed,
+                           const bool dump, RecordWriter& writer,
+                           const Baseline* const baseline,
+                           std::vector<Comparison>& comparisons)
+    {
+        using T = typename E::Type;
+
+        const auto text = (opts.format == Format::text);
+
+        const auto& algos = algorithms<T>();
+        const auto& counted_algos = algorithms<Counted<T>>();
+        const auto& adversarial_algos = algorithms<adversary::Element>();
+        const auto& indexed_algos = algorithms<Indexed<T>>();
+
+        std::vector<bool> chosen;
+        for (const auto& a : algos) {
+            chosen.push_back(empty(opts.algo_patterns)
+                    || std::any_of(cbegin(opts.algo_patterns),
+                                   cend(opts.algo_patterns),
+                                   [&a](const AlgorithmPattern& pattern) {
+                return algorithm_matches(pattern, a.name, a.label);
+            }));
+        }
+
+        // Algorithms that went over budget on a smaller input like this one.
+        std::vector<bool> over_budget (size(algos));
+
+        // Each algorithm's median times on smaller inputs like this one.
+        std::vector<std::vector<std::tuple<std::size_t, double>>> history (
+                size(algos));
+
+        const auto budget_ns = opts.budget * 1e9;
+        // The watchdog allows for the runs, plus up to two more for the
+        // operation count and stability check.
+        const auto limit = opts.budget * (opts.trials.warmups
+                                          + opts.trials.timed + 2) + 1.0;
+
+        const auto is_chosen = [&](const std::string_view lbl) {
+            const auto p = std::find_if(cbegin(algos), cend(algos),
+                                        [lbl](const Algorithm<T>& a) {
+                return a.label == lbl;
+            });
+            if (p == cend(algos)) return false;
+
+            const auto i = static_cast<std::size_t>(p - cbegin(algos));
+            return chosen[i] && !over_budget[i];
+        };
+
+        // Predicts algorithm i's time per run on len elements from its
+        // times on smaller inputs like this one.
+        const auto estimate = [&](const std::size_t i, const std::size_t len) {
+            return predict_time(history[i], len,
+                                algos[i].group == Group::fast ? 1.1 : 2.0);
+        };
+
+        // Tests the algorithms (or only the one given) on a pristine input
+        // v. Each algorithm's runs sort copies of it in a working buffer that
+        // the watched child allocates, so this process holds only v, and the
+        // child (reading v without copying it) holds v and the buffer.
+        const auto test_input = [&](const std::vector<T>& v,
+                                    const std::string_view kind,
+                                    const std::optional<std::size_t> only
+                                        = std::nullopt) {
+            if (text) {
+                std::cout << size(v) << "-element " << kind << ' ' << E::name
+                          << " vector";
+                if (only) std::cout << " built against " << algos[*only].name;
+                print_if_small(v);
+                std::cout << ".\n";
+            }
+
+            const auto fingerprint = fingerprints::of(v);
+
+            const auto bytes = size(v) * sizeof(T);
+            const auto bounds = (opts.roofline
+                    ? std::optional{calibration::bounds(
+                            calibration::at(bytes), size(v), bytes)}
+                    : std::nullopt);
+            if (bounds && text) calibration::print(bounds->bandwidth, bytes);
+
+            // The algorithms to run on this input, in the order they run.
+            std::vector<std::size_t> order;
+            for (std::size_t i = 0; i != size(algos); ++i) {
+                const auto& a = algos[i];
+
+                if (!chosen[i] || (only && i != *only)
+                        || (a.group == Group::slowest && opts.skip_slowest))
+                    continue;
+
+                if (baseline && baseline->times.count({std::string{a.name},
+                                                       std::string{E::name},
+                                                       std::string{kind},
+                                                       size(v)}) == 0)
+                    continue;
+
+                order.push_back(i);
+            }
+
+            auto shuffler = distributions::make_engine(seed, "order"sv,
+                                                       size(v));
+            if (opts.order == Order::random)
+                std::shuffle(begin(order), end(order), shuffler);
+
+            // Whether to skip algorithm i on this input, printing why if so.
+            const auto skip = [&](const std::size_t i) {
+                const auto& a = algos[i];
+
+                const auto skipped = [&](const auto&... why) {
+                    if (text) {
+                        auto& out = std::cout << a.label << ": skipped (";
+                        (out << ... << why) << ").\n";
+                    }
+                    return true;
+                };
+
+                if (!a.sort) return skipped("unsupported element type");
+
+                if (over_budget[i])
+                    return skipped("over budget on a smaller input");
+
+                if (const auto e = estimate(i, size(v)); e && *e > budget_ns) {
+                    return skipped("estimated ", Nanoseconds{*e},
+                                   " per run, over budget");
+                }
+
+                return false;
+            };
+
+            // Runs algorithm i's trials on v and, if check is true, counts
+            // its operations (if asked to) and checks that it is stable (if
+            // it should be). Everything here runs under the watchdog, so an
+            // algorithm that crashes or hangs in the checks is caught too.
+            const auto measure = [&](const std::size_t i,
+                                     const Trials& trials, const bool show,
+                                     const bool check) {
+                auto m = [&] {
+                    std::vector<T> work (size(v));
+                    return run_trials(v, work, algos[i], trials, show,
+                                      opts.count_events, fingerprint);
+                }();
+                if (!check) return m;
+
+                if (opts.count_operations && counted_algos[i].sort)
+                    m.operations = count_operations(v, counted_algos[i]);
+
+                if (algos[i].stable && indexed_algos[i].sort)
+                    m.stable = sorts_stably(v, indexed_algos[i]);
+
+                return m;
+            };
+
+            // Reports that algorithm i's runs were cut short, after its
+            // label.
+            const auto interrupt = [&](const std::size_t i,
+                                       const Interruption& p) {
+                if (text) {
+                    std::cout << ' ' << p.reason << ".\n";
+                } else {
+                    std::cerr << algos[i].name << " on " << size(v)
+                              << "-element " << kind << ' ' << E::name
+                              << " vector: " << p.reason << '\n';
+                }
+
+                over_budget[i] = true;
+            };
+
+            // Reports and records algorithm i's measurement, after its label.
+            const auto record = [&](const std::size_t i, Measurement& m) {
+                const auto& a = algos[i];
+                const Cell cell {a.name, a.label, E::name, kind, size(v)};
+
+                history[i].emplace_back(size(v), m.summary.median);
+                m.bounds = bounds;
+
+                if (text) {
+                    print_measurement(m, size(v));
+                    if (m.bounds)
+                        calibration::print_roofline(*m.bounds,
+                                                    m.summary.median);
+                    counters::print_counts(m.samples, size(v));
+                    if (m.operations)
+                        print_operation_counts(*m.operations, size(v));
+                    if (opts.show_memory)
+                        print_allocations(m.allocations);
+                }
+
+                writer.write(cell, m);
+
+                if (baseline) {
+                    if (const auto c = compare(*baseline, cell, m,
+                                               opts.alpha,
+                                               opts.min_effect))
+                        comparisons.push_back(*c);
+                }
+
+                if (m.summary.median > budget_ns) over_budget[i] = true;
+            };
+
+            if (opts.order != Order::interleave) {
+                for (const auto i : order) {
+                    if (skip(i)) continue;
+
+                    if (text) std::cout << algos[i].label << ':' << std::flush;
+
+                    auto result = run_watched([&] {
+                        return measure(i, opts.trials, text, true);
+                    }, limit);
+
+                    if (const auto p = std::get_if<Interruption>(&result))
+                        interrupt(i, *p);
+                    else
+                        record(i, std::get<Measurement>(result));
+                }
+            } else {
+                order.erase(std::remove_if(begin(order), end(order), skip),
+                            end(order));
+
+                // Run one trial of each algorithm per round, in a new order
+                // each round, and merge each algorithm's trials. Each round
+                // runs in a new process, so each has its warm-up runs.
+                std::vector<std::optional<Measurement>> merged (size(algos));
+                const Trials trials {opts.trials.warmups, 1};
+                const auto round_limit = opts.budget * (trials.warmups + 3)
+                                         + 1.0;
+
+                for (auto round = 0; round != opts.trials.timed; ++round) {
+                    std::shuffle(begin(order), end(order), shuffler);
+
+                    for (const auto i : order) {
+                        if (over_budget[i]) continue;
+
+                        auto result = run_watched([&] {
+                            return measure(i, trials, false, round == 0);
+                        }, round_limit);
+
+                        if (const auto p = std::get_if<Interruption>(&result)) {
+                            if (text) std::cout << algos[i].label << ':';
+                            interrupt(i, *p);
+                            merged[i].reset();
+                            continue;
+                        }
+
+                        auto& m = std::get<Measurement>(result);
+                        if (!merged[i]) {
+                            merged[i] = std::move(m);
+                            continue;
+                        }
+
+                        auto& all = *merged[i];
+                        all.times.insert(end(all.times), cbegin(m.times),
+                                         cend(m.times));
+                        all.samples.insert(end(all.samples),
+                                           cbegin(m.samples),
+                                           cend(m.samples));
+                        all.allocations.insert(end(all.allocations),
+                                               cbegin(m.allocations),
+                                               cend(m.allocations));
+                        all.ok = all.ok && m.ok;
+                    }
+                }
+
+                std::sort(begin(order), end(order));
+                for (const auto i : order) {
+                    if (!merged[i]) continue;
+
+                    merged[i]->summary = summarize(merged[i]->times);
+                    if (text) std::cout << algos[i].label << ':';
+                    record(i, *merged[i]);
+                }
+            }
+
+            if (text) {
+                if (size(v) <= comparison_count_threshold && !only)
+                    test_comparison_counts(v, is_chosen);
+
+                std::cout << '\n';
+            }
+        };
+
+        // Tests each algorithm on an input of len elements built against it
+        // by the adversary, which gets as long as a run would.
+        const auto test_attacks = [&](const std::size_t len) {
+            for (std::size_t i = 0; i != size(algos); ++i) {
+                const auto& a = algos[i];
+
+                if (!chosen[i] || !a.sort || !adversarial_algos[i].sort
+                        || (a.group == Group::slowest && opts.skip_slowest))
+                    continue;
+
+                // Reports why there is no input to test.
+                const auto skipped = [&](const auto&... why) {
+                    if (text) {
+                        auto& out = std::cout << len << "-element antiqsort "
+                                              << E::name
+                                              << " vector built against "
+                                              << a.name << ": skipped (";
+                        (out << ... << why) << ").\n\n";
+                    }
+                };
+
+                if (over_budget[i]) {
+                    skipped("over budget on a smaller input");
+                    continue;
+                }
+
+                if (const auto e = estimate(i, len); e && *e > budget_ns) {
+                    skipped("estimated ", Nanoseconds{*e},
+                            " per run, over budget");
+                    continue;
+                }
+
+                const auto deadline = std::chrono::steady_clock::now()
+                        + std::chrono::duration_cast<
+                                std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>{
+                                            opts.budget});
+
+                const auto attack = adversary::attack(adversarial_algos[i],
+                                                      len, deadline);
+                if (!attack) {
+                    skipped("the adversary ran over budget");
+                    over_budget[i] = true;
+                    continue;
+                }
+
+                if (dump) {
+                    dump_keys(*attack, *opts.dump_prefix,
+                              "antiqsort-" + std::string{a.name});
+                }
+
+                test_input(make_elements<E>(*attack), "antiqsort", i);
+            }
+        };
+
+        if (empty(opts.sizes) && !opts.sweep) {
+            const std::vector<std::vector<int>> examples {
+                {111, 333, 222},
+                {3, 7, 1, 5, 2, -6, 15, 4, 33, -5},
+                {9, 9, 1, 8, 3, 0, 2, 0, 7, 15, 4, 3, 3},
+                {2, 1},
+                {1, 2},
+                {5},
+                {},
+            };
+
+            for (const auto& keys : examples)
+                test_input(make_elements<E>(keys), "example");
+        }
+
+        const auto caches = get_caches();
+
+        auto sizes = (!empty(opts.sizes) ? opts.sizes
+                : opts.sweep ? sweep_sizes(caches, sizeof(T))
+                : std::vector<std::size_t>(cbegin(default_sizes),
+                                           cend(default_sizes)));
+
+        sizes.erase(std::remove_if(begin(sizes), end(sizes),
+                                   [](const std::size_t len) {
+            if (len <= max_input_bytes / sizeof(T)) return false;
+
+            std::cerr << "warning: skipping " << len << "-element " << E::name
+                      << " inputs, which would take over " << max_input_bytes
+                      << " bytes\n";
+            return true;
+        }), end(sizes));
+
+        for (const auto& dist : opts.dists) {
+            std::fill(begin(over_budget), end(over_budget), false);
+            for (auto& times : history) times.clear();
+
+            // Generate each input only when it is needed, so at most one is
+            // held at a time.
+            for (const auto len : sizes) {
+                if (!dist.generate) {
+                    test_attacks(len);
+                    continue;
+                }
+
+                const auto v = [&] {
+                    auto eng = distributions::make_engine(seed, dist.name,
+                                                          len);
+                    const auto keys = dist.generate(len, eng);
+                    if (dump) dump_keys(keys, *opts.dump_prefix, dist.name);
+                    return make_elements<E>(keys);
+                }();
+
+                test_input(v, dist.name);
+            }
+
+            if (!opts.sweep) continue;
+
+            if (std::all_of(cbegin(history), cend(history),
+                            [](const auto& times) { return empty(times); }))
+                continue;
+
+            // Keep machine-readable output parseable.
+            auto& out = (text ? std::cout : std::cerr);
+            out << "Scaling on " << dist.name << ' ' << E::name
+                << " inputs, fitted to a n^b lg n:\n";
+            for (std::size_t i = 0; i != size(algos); ++i) {
+                if (!empty(history[i]))
+                    print_scaling(out, algos[i].label, history[i], caches,
+                                  sizeof(T));
+            }
+            out << '\n';
+        }
+    }
 }
 
 int main(int argc, char **argv)
 {
-    const auto do_slowest = will_do_slowest(argc, argv);
-    auto gen = make_generator();
-
-    const std::vector<std::vector<int>> vs {
-        {111, 333, 222},
-        {3, 7, 1, 5, 2, -6, 15, 4, 33, -5},
-        {9, 9, 1, 8, 3, 0, 2, 0, 7, 15, 4, 3, 3},
-        {2, 1},
-        {1, 2},
-        {5},
-        {},
-        gen(6),
-        gen(1000),
-        gen(10'000),
-        gen(100'000),
-        gen(250'000),
-        gen(500'000),
-        gen(1'000'000),
-        gen(10'000'000),
-        gen(100'000'000),
-        //gen(1'000'000'000)
+    // Significant digits of times and costs.
+    std::cout.precision(3);
+    std::cerr.precision(3);
+
+    auto opts = parse_options(argc, argv);
+    if (!opts) return EXIT_FAILURE;
+
+    if (opts->help) {
+        print_usage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+
+    if (opts->list) {
+        print_list();
+        return EXIT_SUCCESS;
+    }
+
+    if (opts->cpu && !pin_to_cpu(*opts->cpu)) {
+        std::cerr << "error: can't run on CPU " << *opts->cpu << '\n';
+        return EXIT_FAILURE;
+    }
+
+#ifdef __linux__
+    if (const auto cpu = sched_getcpu(); cpu >= 0)
+        check_cpu(static_cast<unsigned>(cpu));
+#endif
+
+    std::optional<Baseline> baseline;
+    if (opts->baseline_path) {
+        baseline = load_baseline(std::string{*opts->baseline_path});
+        if (!baseline) return EXIT_FAILURE;
+        if (!restrict_to_baseline(*opts, *baseline)) {
+            std::cerr << "error: no cells of the baseline match the options\n";
+            return EXIT_FAILURE;
+        }
+        if (!ensure_baseline_power(*opts, *baseline)) return EXIT_FAILURE;
+        if (!opts->seed) opts->seed = baseline->seed;
+    }
+
+    const auto seed = opts->seed.value_or([] {
+        std::random_device rd;
+        return std::uint64_t{rd()} << 32 | rd();
+    }());
+
+    // Machine-readable records carry the seed instead.
+    if (opts->format == Format::text) {
+        std::cout << "Seed: " << seed << " (pass --seed=" << seed
+                  << " to reproduce these inputs)\n\n";
+    }
+
+    std::vector<Comparison> comparisons;
+
+    if (opts->count_events)
+        counters::report_unavailable(counters::PerfCounters{});
+
+    if (opts->huge_pages) {
+        report_huge_pages();
+#ifdef __linux__
+        map_large_blocks = true;
+#endif
+    }
+
+    {
+        RecordWriter writer {opts->format, get_environment(seed)};
+
+        // The keys are the same for every element type, so dump them once.
+        auto dump = opts->dump_prefix.has_value();
+
+        for_each_element_type([&](const auto e) {
+            using E = decltype(e);
+
+            if (std::find(cbegin(opts->type_names), cend(opts->type_names),
+                          E::name) != cend(opts->type_names)) {
+                test_element_type<E>(*opts, seed, dump, writer,
+                                     baseline ? &*baseline : nullptr,
+                                     comparisons);
+                dump = false;
+            }
+        });
+    }
+
+    if (!baseline) return EXIT_SUCCESS;
+
+    // Keep machine-readable output parseable.
+    auto& out = (opts->format == Format::text ? std::cout : std::cerr);
+    print_comparisons(out, comparisons, opts->alpha, opts->min_effect);
+
+    const auto regressed = std::any_of(cbegin(comparisons), cend(comparisons),
+                                       [](const Comparison& c) {
+        return c.verdict == Verdict::regression;
+    });
+
+    return regressed ? 2 : EXIT_SUCCESS;
+}
+
+// Replacements for the global allocation functions, which keep
+// allocation_stats up to date. The other forms, such as array and nothrow
+// new, call these by default. Over-aligned allocations are not counted.
+// Each block has a header holding its size, so the unsized delete knows it,
+// and the length of its mapping if it was mapped (see map_large_blocks).
+
+namespace {
+    constexpr auto allocation_header_size = alignof(std::max_align_t);
+    static_assert(allocation_header_size >= 2 * sizeof(std::size_t));
+
+#ifdef __linux__
+    constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+    struct Mapping {
+        void* base;
+        std::size_t length;
     };
 
-    for (const auto& v : vs) {
-        std::cout << size(v) << "-element vector";
-        print_if_small(v);
-        std::cout << ".\n";
+    // Freed mappings, kept to be reused so that later runs don't fault
+    // their pages in again.
+    std::array<Mapping, 16> spare_mappings {};
+
+    // Unmaps the spare mappings.
+    void release_spare_mappings() noexcept
+    {
+        for (auto& spare : spare_mappings) {
+            if (spare.base) munmap(spare.base, spare.length);
+            spare = {};
+        }
+    }
 
-        if (size(v) <= slow_threshold) {
-            test_insertion_sorts(v);
-            if (do_slowest) test_other_slow(v);
+    // Maps at least length bytes, a multiple of huge_page_size, aligned to a
+    // huge page. The pages are faulted in after asking for huge pages, as
+    // MAP_POPULATE would fault them in as small pages before madvise could
+    // ask. Returns a null base if mapping fails.
+    Mapping map_block(const std::size_t length) noexcept
+    {
+        const auto best = std::min_element(begin(spare_mappings),
+                                           end(spare_mappings),
+                                           [length](const Mapping& lhs,
+                                                    const Mapping& rhs) {
+            const auto fits = [length](const Mapping& m) {
+                return m.base && m.length >= length;
+            };
+            if (fits(lhs) != fits(rhs)) return fits(lhs);
+            return lhs.length < rhs.length;
+        });
+        if (best->base && best->length >= length)
+            return std::exchange(*best, Mapping{});
+
+        const auto padded = length + huge_page_size;
+        auto p = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            release_spare_mappings();
+            p = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) return {};
         }
 
-        test_fast(v);
+        // Trim the mapping to an aligned block of length bytes.
+        const auto address = reinterpret_cast<std::uintptr_t>(p);
+        const auto head = (huge_page_size - address % huge_page_size)
+                            % huge_page_size;
+        const auto base = static_cast<unsigned char*>(p) + head;
+        if (head != 0) munmap(p, head);
+        if (padded - head != length)
+            munmap(base + length, padded - head - length);
+
+        madvise(base, length, MADV_HUGEPAGE); // fails without huge pages
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(base, length, MADV_POPULATE_WRITE) != 0)
+#endif
+        {
+            const auto page_size = static_cast<std::size_t>(
+                    sysconf(_SC_PAGESIZE));
+            for (std::size_t i = 0; i < length; i += page_size)
+                static_cast<volatile unsigned char*>(base)[i] = 0;
+        }
 
-        std::cout << '\n';
+        return {base, length};
+    }
+
+    // Keeps a mapping to be reused, unmapping it if there is no room.
+    void unmap_block(const Mapping mapping) noexcept
+    {
+        const auto free_slot = std::find_if(begin(spare_mappings),
+                                            end(spare_mappings),
+                                            [](const Mapping& m) {
+            return !m.base;
+        });
+
+        if (free_slot != end(spare_mappings))
+            *free_slot = mapping;
+        else
+            munmap(mapping.base, mapping.length);
+    }
+#endif
+}
+
+void* operator new(const std::size_t size)
+{
+    unsigned char* block {};
+    std::size_t mapped_length {};
+
+#ifdef __linux__
+    if (map_large_blocks && size >= huge_page_size) {
+        const auto needed = allocation_header_size + size;
+        const auto [base, length] = map_block(
+                (needed + huge_page_size - 1) / huge_page_size
+                    * huge_page_size);
+        block = static_cast<unsigned char*>(base);
+        mapped_length = length;
+    }
+#endif
+
+    if (!block) {
+        block = static_cast<unsigned char*>(
+                std::malloc(allocation_header_size + size));
+        if (!block) throw std::bad_alloc{};
+    }
+
+    std::memcpy(block, &size, sizeof size);
+    std::memcpy(block + sizeof size, &mapped_length, sizeof mapped_length);
+
+    allocation_stats.allocated(size);
+
+    return block + allocation_header_size;
+}
+
+void operator delete(void* const p) noexcept
+{
+    if (!p) return;
+
+    const auto block = static_cast<unsigned char*>(p) - allocation_header_size;
+    std::size_t size {}, mapped_length {};
+    std::memcpy(&size, block, sizeof size);
+    std::memcpy(&mapped_length, block + sizeof size, sizeof mapped_length);
+
+    allocation_stats.freed(size);
+
+#ifdef __linux__
+    if (mapped_length != 0) {
+        unmap_block({block, mapped_length});
+        return;
     }
+#endif
+
+    std::free(block);
+}
+
+void operator delete(void* const p, std::size_t) noexcept
+{
+    operator delete(p);
 }
@@ -0,0 +1,1924 @@
+// sorts.h - The sorting algorithms, and the element types and input
+// distributions they are run on, shared by the benchmark and its tests.
+//
+// Written in 2018, 2019 by Eliah Kagan <degeneracypressure@gmail.com>.
+//
+// To the extent possible under law, the author(s) have dedicated all copyright
+// and related and neighboring rights to this software to the public domain
+// worldwide. This software is distributed without any warranty.
+//
+// You should have received a copy of the CC0 Public Domain Dedication along
+// with this software. If not, see
+// <http://creativecommons.org/publicdomain/zero/1.0/>.
+
+#ifndef SORTS_H
+#define SORTS_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <stack>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+    using namespace std::string_view_literals;
+
+    namespace detail {
+        template<typename It>
+        using Delta = typename std::iterator_traits<It>::difference_type;
+
+        template<typename It>
+        using ValueType = typename std::iterator_traits<It>::value_type;
+    }
+
+    template<typename It>
+    void insertion_sort(const It first, const It last)
+    {
+        if (first == last) return;
+
+        for (auto right = std::next(first); right != last; ++right) {
+            auto elem = std::move(*right);
+
+            auto left = right;
+            for (; left != first && elem < *std::prev(left); --left)
+                *left = std::move(*std::prev(left));
+
+            *left = std::move(elem);
+        }
+    }
+
+    template<typename It>
+    void insertion_sort_byswap(const It first, const It last)
+    {
+        if (first == last) return;
+
+        for (auto right = std::next(first); right != last; ++right) {
+            for (auto left = right; left != first && *left < *std::prev(left);
+                                    --left)
+                std::iter_swap(left, std::prev(left));
+        }
+    }
+
+    template<typename It>
+    void binary_insertion_sort(const It first, const It last)
+    {
+        if (first == last) return;
+
+        for (auto right = std::next(first); right != last; ++right) {
+            auto elem = std::move(*right);
+
+            const auto left = std::upper_bound(first, right, elem);
+            std::move_backward(left, right, std::next(right));
+
+            *left = std::move(elem);
+        }
+    }
+
+    template<typename It>
+    void binary_insertion_sort_byrotate(const It first, const It last)
+    {
+        if (first == last) return;
+
+        for (auto right = std::next(first); right != last; ++right) {
+            const auto left = std::upper_bound(first, right, *right);
+            std::rotate(left, right, std::next(right));
+        }
+    }
+
+    namespace detail::merge_insertion {
+        using Index = std::size_t;
+        using Chain = std::vector<Index>;
+
+        // Sorts the indices in a by the elements they refer to (compared by
+        // less), using Ford-Johnson merge-insertion.
+        template<typename Less>
+        void sort(Chain& a, const Less less)
+        {
+            const auto len = size(a);
+            if (len < 2) return;
+
+            // Compare disjoint pairs, keeping each pair's larger element (in
+            // winners) beside its smaller element (in partners).
+            const auto half = len / 2;
+            Chain winners (half);
+            std::vector<std::pair<Index, Index>> partners (half);
+
+            for (Index i = 0; i != half; ++i) {
+                auto lo = a[i * 2], hi = a[i * 2 + 1];
+                if (less(hi, lo)) std::swap(lo, hi);
+                winners[i] = hi;
+                partners[i] = {hi, lo};
+            }
+
+            // Recursively sort the larger elements into the main chain.
+            sort(winners, less);
+
+            // Collect the smaller elements in the order of their partners in
+            // the main chain. Any unpaired element goes last, with no partner.
+            std::sort(begin(partners), end(partners));
+            Chain pend;
+            pend.reserve(len - half);
+            for (const auto winner : winners) {
+                pend.push_back(std::lower_bound(begin(partners), end(partners),
+                                                std::pair{winner, Index{}})
+                                    ->second);
+            }
+            if (len % 2 != 0) pend.push_back(a.back());
+
+            // The first pending element is less than the first in the chain.
+            a.clear();
+            a.push_back(pend.front());
+            a.insert(end(a), cbegin(winners), cend(winners));
+
+            // Insert the others in groups whose ends follow the Jacobsthal
+            // numbers (1, 3, 5, 11, 21, ...), each group in decreasing order,
+            // so every binary search is over at most 2^k - 1 elements.
+            for (Index done = 1, next = 3; done != size(pend); ) {
+                const auto group_last = std::min(next, size(pend));
+
+                for (auto j = group_last; j != done; --j) {
+                    const auto elem = pend[j - 1];
+
+                    // Search only up to the partner, if there is one. It is
+                    // preceded by j - 1 winners and the first done pending
+                    // elements, and by some of those already in this group.
+                    auto bound = end(a);
+                    if (j <= half) {
+                        const auto start = static_cast<std::ptrdiff_t>(
+                                j - 1 + done);
+                        bound = std::find(begin(a) + start, end(a),
+                                          winners[j - 1]);
+                    }
+
+                    a.insert(std::upper_bound(begin(a), bound, elem, less),
+                             elem);
+                }
+
+                next = group_last + done * 2;
+                done = group_last;
+            }
+        }
+    }
+
+    // Ford-Johnson merge-insertion sort (Ford & Johnson 1959,
+    // https://doi.org/10.2307/2308750; see also Knuth, TAOCP vol. 3, 5.3.1).
+    // It makes close to the fewest comparisons possible, so it is only worth
+    // it when comparisons are much more expensive than moves.
+    template<typename It>
+    void merge_insertion_sort(const It first, const It last)
+    {
+        const auto len = static_cast<std::size_t>(std::distance(first, last));
+
+        detail::merge_insertion::Chain order (len);
+        std::iota(begin(order), end(order), std::size_t{0});
+
+        detail::merge_insertion::sort(order, [first](const std::size_t i,
+                                                     const std::size_t j) {
+            return first[static_cast<detail::Delta<It>>(i)]
+                    < first[static_cast<detail::Delta<It>>(j)];
+        });
+
+        std::vector<detail::ValueType<It>> aux;
+        aux.reserve(len);
+        for (const auto i : order)
+            aux.push_back(std::move(first[static_cast<detail::Delta<It>>(i)]));
+        std::move(begin(aux), end(aux), first);
+    }
+
+    template<typename It>
+    void selection_sort(It first, const It last)
+    {
+        for (; first != last; ++first)
+            std::iter_swap(std::min_element(first, last), first);
+    }
+
+    template<typename It>
+    void bubble_sort(const It first, const It last)
+    {
+        if (first == last) return;
+
+        for (auto again = true; again; ) {
+            again = false;
+
+            for (auto left = first, right = std::next(left); right != last;
+                                                             ++left, ++right) {
+                if (*right < *left) {
+                    std::iter_swap(left, right);
+                    again = true;
+                }
+            }
+        }
+    }
+
+    template<typename It>
+    void bubble_sort_nonadaptive(const It first, It last)
+    {
+        for (; first != last; --last) {
+            for (auto left = first, right = std::next(left); right != last;
+                                                             ++left, ++right) {
+                if (*right < *left) std::iter_swap(left, right);
+            }
+        }
+    }
+
+    template<typename It>
+    void bubble_sort_maxadaptive(const It first, It last)
+    {
+        while (first != last) {
+            auto last_swapped = first;
+
+            for (auto left = first, right = std::next(left); right != last;
+                                                             ++left, ++right) {
+                if (*right < *left) {
+                    std::iter_swap(left, right);
+                    last_swapped = right;
+                }
+            }
+
+            last = last_swapped;
+        }
+    }
+
+    template<typename It>
+    void gnome_sort(const It first, const It last)
+    {
+        for (auto cur = first; cur != last; ) {
+            if (cur == first || !(*cur < *std::prev(cur))) {
+                ++cur;
+            } else {
+                std::iter_swap(cur, std::prev(cur));
+                --cur;
+            }
+        }
+    }
+
+    namespace detail {
+        template<typename It>
+        void insertion_sort_subsequence(const It first, const It last,
+                                        const Delta<It> gap)
+        {
+            const auto len = last - first;
+
+            for (auto right = gap; right < len; right += gap) {
+                auto elem = std::move(first[right]);
+
+                auto left = right;
+                for (; left != 0 && elem < first[left - gap]; left -= gap)
+                    first[left] = std::move(first[left - gap]);
+
+                first[left] = std::move(elem);
+            }
+        }
+
+        template<typename It, typename Gen>
+        void shellsort(const It first, const It last, const Gen generate_gaps)
+        {
+            // Get the gap sequence.
+            std::vector<Delta<It>> gaps;
+            generate_gaps(last - first, std::back_inserter(gaps));
+            assert(empty(gaps) || gaps.front() == 1);
+
+            // Do all nonoverlapping gapped insertion sorts for each gap value.
+            std::for_each(std::crbegin(gaps), std::crend(gaps),
+                          [first, last](const Delta<It> gap) {
+                const auto bound = first + gap;
+
+                for (auto start = first; start != bound; ++start)
+                    insertion_sort_subsequence(start, last, gap);
+            });
+        }
+
+        // This ratio appears in the computations of some of the experimentally
+        // faster (average-case) gap sequences for shellsort.
+        constexpr auto nine_fourths = 2.25;
+
+        // This is the fastest known sequence in the average case, based on
+        // experimental evidence. Only nine terms are known (with no formula).
+        constexpr std::array ciura_gaps = {
+                1, 4, 10, 23, 57, 132, 301, 701, 1750};
+    }
+
+    namespace detail::gaps {
+        // Generates gaps consisting of one less than powers of 2. Found by
+        // Hibbard 1963: https://dl.acm.org/citation.cfm?doid=366552.366557
+        constexpr auto hibbard = [](const auto len, auto d_first) {
+            for (auto k = 1; ; ++k) {
+                const auto g = (decltype(len){1} << k) - 1;
+                if (g >= len) break;
+                *d_first++ = g;
+            }
+        };
+
+        // Generates gaps consisting of the 3-smooth numbers. Pratt 1971 showed
+        // shellsort with this sequence has optimal worst-case asymptotic time
+        // complexity, http://www.dtic.mil/get-tr-doc/pdf?AD=AD0740110, but on
+        // average it is slower than the popular sequences. I generate them with
+        // David Eisenstat's method https://stackoverflow.com/a/25344494
+        // (Eisenstat 2014) based on Dijkstra's solution to the Hamming problem
+        // (Dijkstra 1976, see https://en.wikipedia.org/wiki/Regular_number).
+        constexpr auto three_smooth = [](const auto len, auto d_first) {
+            std::vector<std::remove_const_t<decltype(len)>> aux;
+            decltype(size(aux)) co_two_pos {}, co_three_pos {};
+
+            for (aux.push_back({1}); aux.back() < len; ) {
+                *d_first++ = aux.back();
+
+                const auto two_multiple = aux[co_two_pos] * 2;
+                const auto three_multiple = aux[co_three_pos] * 3;
+
+                aux.push_back(std::min(two_multiple, three_multiple));
+
+                if (two_multiple <= three_multiple) ++co_two_pos;
+                if (three_multiple <= two_multiple) ++co_three_pos;
+            }
+        };
+
+        // Generate gaps whose rate of increase gradually rises. Found by
+        // Sedgewick 1986: https://doi.org/10.1016/0196-6774(86)90001-5 p.165
+        // See also https://oeis.org/A036562.
+        constexpr auto sedgewick = [](const auto len, auto d_first) {
+            if (len == 0) return;
+
+            constexpr decltype(len) one {1};
+            *d_first++ = one;
+
+            for (auto i = 0; ; ++i) {
+                const auto g = (one << (i + 1) * 2) + (one << i) * 3 + 1;
+                if (g >= len) break;
+                *d_first++ = g;
+            }
+        };
+
+        // Generates gaps that increase by a bit more than 9/4. Found by
+        // Tokuda 1992: https://dl.acm.org/citation.cfm?id=659879. See also
+        // https://oeis.org/A108870. The formula used here appears in
+        // https://en.wikipedia.org/wiki/Shellsort#Gap_sequences.
+        constexpr auto tokuda = [](const auto len, auto d_first) {
+            for (auto h = 1.0; ; h = h * nine_fourths + 1.0) {
+                const auto g = static_cast<decltype(len)>(std::ceil(h));
+                if (g >= len) break;
+                *d_first++ = g;
+            }
+        };
+
+        // Generates gaps that increase according to the short experimentally
+        // derived sequence in Ciura 2001, and then by a bit less than 9/4. See
+        // http://sun.aei.polsl.pl/~mciura/publikacje/shellsort.pdf and
+        // https://oeis.org/A102549 for the initial sequence and
+        // https://en.wikipedia.org/wiki/Shellsort#Gap_sequences for the
+        // idea of extending it in this way.
+        constexpr auto quasi_ciura = [](const auto len, auto d_first) {
+            auto g = decltype(len){};
+
+            for (const auto h : ciura_gaps) {
+                g = decltype(len){h};
+                if (g >= len) return;
+                *d_first++ = g;
+            }
+
+            while ((g = static_cast<decltype(len)>(g * nine_fourths)) < len)
+                *d_first++ = g;
+        };
+    }
+
+    template<typename It>
+    void shellsort_hibbard(const It first, const It last)
+    {
+        detail::shellsort(first, last, detail::gaps::hibbard);
+    }
+
+    template<typename It>
+    void shellsort_3smooth(const It first, const It last)
+    {
+        detail::shellsort(first, last, detail::gaps::three_smooth);
+    }
+
+    template<typename It>
+    void shellsort_sedgewick(const It first, const It last)
+    {
+        detail::shellsort(first, last, detail::gaps::sedgewick);
+    }
+
+    template<typename It>
+    void shellsort_tokuda(const It first, const It last)
+    {
+        detail::shellsort(first, last, detail::gaps::tokuda);
+    }
+
+    template<typename It>
+    void shellsort_quasi_ciura(const It first, const It last)
+    {
+        detail::shellsort(first, last, detail::gaps::quasi_ciura);
+    }
+
+    namespace detail {
+        template<typename It>
+        constexpr bool possibly_unsorted(It first, const It last) noexcept
+        {
+            return first != last && ++first != last;
+        }
+
+        template<typename It>
+        constexpr It midpoint(It first, const It last) noexcept
+        {
+            std::advance(first, std::distance(first, last) / 2);
+            return first;
+        }
+
+        template<typename It>
+        auto
+        make_aux(const Delta<It> len)
+        {
+            std::vector<ValueType<It>> aux;
+            aux.reserve(static_cast<decltype(size(aux))>(len));
+            return aux;
+        }
+
+        template<typename T, typename It>
+        void merge(std::vector<T>& aux, const It first1, // "last1" is first2
+                                        const It first2, const It last2)
+        {
+            auto cur1 = first1, cur2 = first2;
+
+            // Merge elements from both ranges to aux until one is empty.
+            while (cur1 != first2 && cur2 != last2) {
+                auto& cur = (*cur2 < *cur1 ? cur2 : cur1);
+                aux.push_back(std::move(*cur));
+                ++cur;
+            }
+
+            // Move the remaining elements from whichever range has them.
+            std::move(cur1, first2, back_inserter(aux));
+            std::move(cur2, last2, back_inserter(aux));
+
+            // Move everything back.
+            std::move(cbegin(aux), cend(aux), first1);
+            aux.clear();
+        }
+
+        // Like merge, but moves only the left range out to aux and merges
+        // forward into [first1, last2). The write position never passes cur2,
+        // so aux needs only as much room as the left range.
+        template<typename T, typename It>
+        void merge_halfbuffer(std::vector<T>& aux, const It first1,
+                              const It first2, const It last2)
+        {
+            std::move(first1, first2, back_inserter(aux));
+
+            auto cur1 = begin(aux);
+            const auto last1 = end(aux);
+            auto out = first1, cur2 = first2;
+
+            // Merge elements from aux and the right range until one is empty.
+            while (cur1 != last1 && cur2 != last2) {
+                if (*cur2 < *cur1)
+                    *out++ = std::move(*cur2++);
+                else
+                    *out++ = std::move(*cur1++);
+            }
+
+            // Any remaining right-range elements are already in place.
+            std::move(cur1, last1, out);
+            aux.clear();
+        }
+    }
+
+    template<typename It>
+    void mergesort_topdown(const It first, const It last)
+    {
+        auto aux = detail::make_aux<It>(std::distance(first, last));
+
+        const auto mergesort_subrange = [&aux](const auto& me, const It first1,
+                                                               const It last2) {
+            const auto delta = std::distance(first1, last2) / 2;
+            if (delta == 0) return;
+
+            const auto first2 = std::next(first1, delta);
+            me(me, first1, first2);
+            me(me, first2, last2);
+            detail::merge(aux, first1, first2, last2);
+        };
+
+        mergesort_subrange(mergesort_subrange, first, last);
+    }
+
+    // Top-down mergesort that needs scratch space for only half the elements,
+    // since the left half is never longer than the right and only the left
+    // range of each merge is moved out.
+    template<typename It>
+    void mergesort_halfbuffer(const It first, const It last)
+    {
+        auto aux = detail::make_aux<It>(std::distance(first, last) / 2);
+
+        const auto mergesort_subrange = [&aux](const auto& me, const It first1,
+                                                               const It last2) {
+            const auto delta = std::distance(first1, last2) / 2;
+            if (delta == 0) return;
+
+            const auto first2 = std::next(first1, delta);
+            me(me, first1, first2);
+            me(me, first2, last2);
+            detail::merge_halfbuffer(aux, first1, first2, last2);
+        };
+
+        mergesort_subrange(mergesort_subrange, first, last);
+    }
+
+    namespace detail {
+        // Stably merges [first1, first2) and [first2, last2), never letting
+        // aux grow past its capacity. Merges that fit use the buffer directly.
+        // Larger ones are split into two smaller merges, until they fit, by
+        // the standard no-buffer rotation merge (Dudzinski & Dydek 1981, and
+        // libstdc++'s __merge_without_buffer): the middle of the longer run
+        // is found in the other by binary search, and a rotation brings the
+        // two parts that belong before it together.
+        template<typename T, typename It>
+        void merge_bounded(std::vector<T>& aux, const It first1,
+                           const It first2, const It last2)
+        {
+            const auto len1 = std::distance(first1, first2);
+            const auto len2 = std::distance(first2, last2);
+            if (len1 == 0 || len2 == 0) return;
+
+            const auto cap = static_cast<Delta<It>>(aux.capacity());
+
+            if (len1 + len2 <= cap) {
+                merge(aux, first1, first2, last2);
+            } else if (len1 <= cap) {
+                merge_halfbuffer(aux, first1, first2, last2);
+            } else if (len1 + len2 == 2) {
+                if (*first2 < *first1) std::iter_swap(first1, first2);
+            } else {
+                auto cut1 = first1, cut2 = first2;
+
+                if (len1 > len2) {
+                    std::advance(cut1, len1 / 2);
+                    cut2 = std::lower_bound(first2, last2, *cut1);
+                } else {
+                    std::advance(cut2, len2 / 2);
+                    cut1 = std::upper_bound(first1, first2, *cut2);
+                }
+
+                const auto mid = std::rotate(cut1, first2, cut2);
+                merge_bounded(aux, first1, cut1, mid);
+                merge_bounded(aux, mid, cut2, last2);
+            }
+        }
+    }
+
+    // Stable top-down mergesort that uses at most aux.capacity() elements of
+    // scratch space, which may be anything from zero to the full length. It
+    // runs in O(n log n) time with a full or half-size buffer and degrades
+    // toward O(n log^2 n) as the buffer shrinks.
+    template<typename It>
+    void mergesort_bounded(const It first, const It last,
+                           std::vector<detail::ValueType<It>>& aux)
+    {
+        assert(empty(aux));
+
+        const auto mergesort_subrange = [&aux](const auto& me, const It first1,
+                                                               const It last2) {
+            const auto delta = std::distance(first1, last2) / 2;
+            if (delta == 0) return;
+
+            const auto first2 = std::next(first1, delta);
+            me(me, first1, first2);
+            me(me, first2, last2);
+            detail::merge_bounded(aux, first1, first2, last2);
+        };
+
+        mergesort_subrange(mergesort_subrange, first, last);
+    }
+
+    template<typename It>
+    void mergesort_topdown_iterative(It first, It last)
+    {
+        auto aux = detail::make_aux<It>(std::distance(first, last));
+        auto post_first = last, post_last = last; // a "null" interval
+        std::stack<std::tuple<It, It>> intervals;
+
+        while (first != last || !empty(intervals)) {
+            // Traverse left as far as possible.
+            for (; first != last; last = detail::midpoint(first, last))
+                intervals.emplace(first, last);
+
+            const auto [first1, last2] = intervals.top();
+
+            if (const auto first2 = detail::midpoint(first1, last2);
+                    // The right branch is big enough to need sorting...
+                    detail::possibly_unsorted(first2, last2)
+                    // ...and we were not just there.
+                        && (first2 != post_first || last2 != post_last)) {
+                // Traverse there next.
+                first = first2;
+                last = last2;
+            } else {
+                // Merge the left and right branches and retreat.
+                detail::merge(aux, first1, first2, last2);
+                post_first = first1;
+                post_last = last2;
+                intervals.pop();
+            }
+        }
+    }
+
+    template<typename It>
+    void mergesort_bottomup_iterative(const It first, const It last)
+    {
+        const auto len = std::distance(first, last);
+        auto aux = detail::make_aux<It>(len);
+
+        for (detail::Delta<It> delta1 {1}; delta1 < len; delta1 *= 2) {
+            detail::Delta<It> sublen {0};
+
+            for (auto first1 = first; (sublen += delta1) < len; ) {
+                const auto first2 = std::next(first1, delta1);
+                const auto delta2 = std::min(delta1, len - sublen);
+                const auto last2 = std::next(first2, delta2);
+
+                detail::merge(aux, first1, first2, last2);
+
+                first1 = last2;
+                sublen += delta2;
+            }
+        }
+    }
+
+    namespace detail {
+        template<typename It>
+        constexpr Delta<It> no_child {-1};
+
+        template<typename It>
+        constexpr Delta<It> pick_child(const It first, const Delta<It> len,
+                                       const Delta<It> parent)
+        {
+            const auto left = parent * 2 + 1;
+            if (left >= len) return no_child<It>;
+
+            const auto right = left + 1;
+            return right == len || !(first[left] < first[right]) ? left : right;
+        }
+
+        // Moves the element at parent down the maxheap [first, first + len),
+        // moving each larger child up into the hole, until it is in place.
+        template<typename It>
+        void sift_down(const It first, const Delta<It> len, Delta<It> parent)
+        {
+            auto elem = std::move(first[parent]);
+
+            for (; ; ) {
+                const auto child = pick_child(first, len, parent);
+                if (child == no_child<It> || !(elem < first[child])) break;
+
+                first[parent] = std::move(first[child]);
+                parent = child;
+            }
+
+            first[parent] = std::move(elem);
+        }
+    }
+
+    template<typename It>
+    void heapsort(const It first, const It last)
+    {
+        auto len = last - first;
+        if (len < 2) return;
+
+        // Rearrange the elements into a binary maxheap.
+        for (auto parent = len / 2; parent >= 0; --parent)
+            detail::sift_down(first, len, parent);
+
+        // Pop each maximum element and place it just after the unsorted region.
+        while (--len != 0) {
+            std::iter_swap(first, first + len);
+            detail::sift_down(first, len, 0);
+        }
+    }
+
+    template<typename It>
+    void heapsort_byswap(const It first, const It last)
+    {
+        auto len = last - first;
+        if (len < 2) return;
+
+        const auto sift_down = [first, &len](detail::Delta<It> parent) {
+            for (; ; ) {
+                const auto child = detail::pick_child(first, len, parent);
+                if (child == detail::no_child<It>
+                        || !(first[parent] < first[child]))
+                    break;
+
+                std::iter_swap(first + parent, first + child);
+                parent = child;
+            }
+        };
+
+        // Rearrange the elements into a binary maxheap.
+        for (auto parent = len / 2; parent >= 0; --parent) sift_down(parent);
+
+        // Pop each maximum element and place it just after the unsorted region.
+        while (--len != 0) {
+            std::iter_swap(first, first + len);
+            sift_down(0);
+        }
+    }
+
+    // Sorts a range in which no element is more than k places from where it
+    // belongs, in O(n log k) time, by moving each element through a minheap
+    // of k + 1 elements. If it finds the bound does not hold, it puts back
+    // the elements it holds and falls back to heapsort.
+    template<typename It>
+    void ksorted_sort(const It first, const It last, const detail::Delta<It> k)
+    {
+        assert(k >= 0);
+
+        const auto greater = [](const auto& lhs, const auto& rhs) {
+            return rhs < lhs;
+        };
+
+        auto heap = detail::make_aux<It>(std::min(k + 1, last - first));
+        auto in = first, out = first;
+
+        for (; in != last && static_cast<detail::Delta<It>>(size(heap)) <= k;
+                ++in) {
+            heap.push_back(std::move(*in));
+            std::push_heap(begin(heap), end(heap), greater);
+        }
+
+        while (!empty(heap)) {
+            std::pop_heap(begin(heap), end(heap), greater);
+
+            if (out != first && heap.back() < *std::prev(out)) {
+                std::move(begin(heap), end(heap), out);
+                heapsort(first, last);
+                return;
+            }
+
+            *out++ = std::move(heap.back());
+            heap.pop_back();
+
+            if (in != last) {
+                heap.push_back(std::move(*in++));
+                std::push_heap(begin(heap), end(heap), greater);
+            }
+        }
+    }
+
+    namespace detail {
+        template<typename It>
+        constexpr void bring_mid_to_front(const It first, const It last)
+        {
+            std::iter_swap(first, midpoint(first, last));
+        }
+
+        template<typename It>
+        constexpr It iter_min(const It p, const It q)
+        {
+            return *q < *p ? q : p;
+        }
+
+        template<typename It>
+        constexpr It median_of_three(const It p, const It q, const It r)
+        {
+            if (*p < *q)
+                return *p < *r ? iter_min(q, r) : p;
+            else
+                return *q < *r ? iter_min(p, r) : q;
+        }
+
+        template<typename It>
+        constexpr void bring_median_of_three_to_front(const It first,
+                                                      const It last)
+        {
+            std::iter_swap(first, median_of_three(first,
+                                                  midpoint(first, last),
+                                                  last - 1));
+        }
+
+        // Sorts in the simple cases of two or fewer elements and returns true,
+        // or moves the median-of-three element to the front and returns false.
+        template<typename It>
+        constexpr bool sorted_after_pivot_selection(const It first, It last)
+        {
+            if (const auto len = last - first; len < 3) {
+                if (len == 2 && *--last < *first) std::iter_swap(first, last);
+                return true;
+            }
+
+            bring_median_of_three_to_front(first, last);
+            return false;
+        }
+    }
+
+    namespace detail::partitions {
+        // Assumes [first, last) is nonempty, partitions it, and returns an
+        // iterator to the pivot. Like the Lomuto scheme, but chooses the pivot
+        // from the beginning, not the end.
+        template<typename It>
+        It lomuto(const It first, const It last)
+        {
+            const auto& pivot = *first;
+            auto mid = first;
+
+            for (auto cur = std::next(first); cur != last; ++cur)
+                if (*cur < pivot) std::iter_swap(++mid, cur);
+
+            std::iter_swap(first, mid);
+            return mid;
+        }
+
+        // Hoare partition scheme. This implementation assumes the first element
+        // in the range is neither the strictly least nor the strictly greatest
+        // element.
+        template<typename It>
+        It hoare(It first, It last)
+        {
+            for (const auto& pivot = *first; ; ) {
+                while (*++first < pivot) { }
+                while (pivot < *--last) { }
+                if (first >= last) return first;
+                std::iter_swap(first, last);
+            }
+        }
+    }
+
+    // Quicksort, using Lomuto partition but choosing the pivot from the middle
+    // of the array (by swapping the first and middle elements and then using
+    // the first element as the pivot). This is the K&R 2 algorithm (p. 87).
+    template<typename It>
+    void quicksort_lomuto_simple(const It first, const It last)
+    {
+        if (detail::possibly_unsorted(first, last)) {
+            detail::bring_mid_to_front(first, last);
+            auto mid = detail::partitions::lomuto(first, last);
+            quicksort_lomuto_simple(first, mid);
+            quicksort_lomuto_simple(++mid, last);
+        }
+    }
+
+    // Same as quicksort_lomuto_simple, but implemented iteratively.
+    template<typename It>
+    void quicksort_lomuto_simple_iterative(It first, It last)
+    {
+        std::stack<std::tuple<It, It>> intervals;
+        intervals.emplace(first, last);
+
+        while (!empty(intervals)) {
+            std::tie(first, last) = intervals.top();
+            intervals.pop();
+
+            if (!detail::possibly_unsorted(first, last)) continue;
+
+            detail::bring_mid_to_front(first, last);
+            const auto mid = detail::partitions::lomuto(first, last);
+            intervals.emplace(std::next(mid), last);
+            intervals.emplace(first, mid);
+        }
+    }
+
+    // Quicksort, using Lomuto partition but choosing the pivot via the median-
+    // of-three technique.
+    template<typename It>
+    void quicksort_lomuto(const It first, const It last)
+    {
+        if (detail::sorted_after_pivot_selection(first, last)) return;
+        auto mid = detail::partitions::lomuto(first, last);
+        quicksort_lomuto(first, mid);
+        quicksort_lomuto(++mid, last);
+    }
+
+    // Same as quicksort_lomuto, but implemented iteratively.
+    template<typename It>
+    void quicksort_lomuto_iterative(It first, It last)
+    {
+        std::stack<std::tuple<It, It>> intervals;
+        intervals.emplace(first, last);
+
+        while (!empty(intervals)) {
+            std::tie(first, last) = intervals.top();
+            intervals.pop();
+
+            if (detail::sorted_after_pivot_selection(first, last)) continue;
+            const auto mid = detail::partitions::lomuto(first, last);
+            intervals.emplace(mid + 1, last);
+            intervals.emplace(first, mid);
+        }
+    }
+
+    // Quicksort using Hoare partition.
+    template<typename It>
+    void quicksort_hoare(const It first, const It last)
+    {
+        if (detail::sorted_after_pivot_selection(first, last)) return;
+        auto mid = detail::partitions::hoare(first, last);
+        quicksort_hoare(first, mid);
+        quicksort_hoare(mid, last);
+    }
+
+    // Quicksort using Hoare partition, but implemented iteratively.
+    template<typename It>
+    void quicksort_hoare_iterative(It first, It last)
+    {
+        std::stack<std::tuple<It, It>> intervals;
+        intervals.emplace(first, last);
+
+        while (!empty(intervals)) {
+            std::tie(first, last) = intervals.top();
+            intervals.pop();
+
+            if (detail::sorted_after_pivot_selection(first, last)) continue;
+            const auto mid = detail::partitions::hoare(first, last);
+            intervals.emplace(mid, last);
+            intervals.emplace(first, mid);
+        }
+    }
+
+    namespace detail::partitions {
+        // Stable three-way partition of [first, last) around a copy of the
+        // median-of-three element, using aux (at least as long as the range)
+        // for scratch space. Lesser elements are moved to aux from the left,
+        // greater ones from the right (so they end up reversed), and equal
+        // ones are compacted toward the front of the range in place. Returns
+        // the subrange that holds the elements equal to the pivot.
+        template<typename T, typename It>
+        std::tuple<It, It> three_way_stable(std::vector<T>& aux,
+                                            const It first, const It last)
+        {
+            const auto pivot = *median_of_three(first, midpoint(first, last),
+                                                std::prev(last));
+
+            const auto aux_last = std::next(begin(aux),
+                                            std::distance(first, last));
+            auto lo = begin(aux), hi = aux_last;
+            auto eq = first;
+
+            for (auto cur = first; cur != last; ++cur) {
+                if (*cur < pivot) {
+                    *lo++ = std::move(*cur);
+                } else if (pivot < *cur) {
+                    *--hi = std::move(*cur);
+                } else {
+                    if (eq != cur) *eq = std::move(*cur); // No self-moves.
+                    ++eq;
+                }
+            }
+
+            const auto first_eq = std::next(first, lo - begin(aux));
+            const auto last_eq = std::next(first_eq, eq - first);
+
+            // Move the equal elements to the middle, then bring the others
+            // back, reversing the greater ones to restore their order.
+            if (first_eq != first) std::move_backward(first, eq, last_eq);
+            std::move(begin(aux), lo, first);
+            std::move(std::make_reverse_iterator(aux_last),
+                      std::make_reverse_iterator(hi), last_eq);
+
+            return {first_eq, last_eq};
+        }
+    }
+
+    // Stable quicksort using an out-of-place three-way partition. Runs of
+    // elements equal to the pivot are finished in one linear pass, so inputs
+    // with many duplicates take far fewer passes than a mergesort does. It
+    // recurses on the smaller side and loops on the larger one, so the stack
+    // depth is logarithmic.
+    template<typename It>
+    void quicksort_stable(const It first, const It last)
+    {
+        std::vector<detail::ValueType<It>> aux (
+                static_cast<std::size_t>(std::distance(first, last)));
+
+        const auto quicksort_subrange = [&aux](const auto& me, It first1,
+                                               It last1) -> void {
+            while (detail::possibly_unsorted(first1, last1)) {
+                const auto [first_eq, last_eq] =
+                        detail::partitions::three_way_stable(aux, first1,
+                                                             last1);
+
+                if (first_eq - first1 < last1 - last_eq) {
+                    me(me, first1, first_eq);
+                    first1 = last_eq;
+                } else {
+                    me(me, last_eq, last1);
+                    last1 = first_eq;
+                }
+            }
+        };
+
+        quicksort_subrange(quicksort_subrange, first, last);
+    }
+
+    template<typename It>
+    void stdlib_heapsort(const It first, const It last)
+    {
+        std::make_heap(first, last);
+        std::sort_heap(first, last);
+    }
+
+    namespace detail {
+        template<typename It>
+        constexpr auto accurate_value_type_v = std::is_same_v<
+                ValueType<It>,
+                std::remove_reference_t<decltype(*std::declval<It>())>>;
+
+        template<typename It>
+        using ValueTypeVector = std::vector<ValueType<It>>;
+
+        template<typename It>
+        constexpr auto known_vector_iterator_v =
+            std::is_same_v<It, typename ValueTypeVector<It>::const_iterator>
+                || std::is_same_v<It, typename ValueTypeVector<It>::iterator>;
+
+        template<typename It>
+        constexpr auto known_contiguous_v =
+            std::is_pointer_v<It> || known_vector_iterator_v<It>;
+    }
+
+    template<typename It>
+    void stdlib_qsort(const It first, const It last)
+    {
+        static_assert(detail::accurate_value_type_v<It>,
+                "iterator appears not to report its value type correctly");
+        static_assert(detail::known_contiguous_v<It>,
+                "iterator type not in the short known-contiguous whitelist");
+        static_assert(!std::is_const_v<detail::ValueType<It>>,
+                "can't safely sort a range using iterators to const");
+        static_assert(std::is_trivial_v<detail::ValueType<It>>,
+                "can't safely std::qsort elements not satisfying TrivialType");
+
+        const auto len = last - first;
+        assert(len >= 0);
+        if (len == 0) return;
+
+        std::qsort(std::addressof(*first), static_cast<std::size_t>(len),
+                   sizeof *first, [](const void* const p, const void* const q) {
+            const auto& lhs = *static_cast<const detail::ValueType<It>*>(p);
+            const auto& rhs = *static_cast<const detail::ValueType<It>*>(q);
+
+            if (lhs < rhs) return -1;
+            if (rhs < lhs) return +1;
+            return 0;
+        });
+    }
+
+    template<typename T>
+    constexpr auto label = label<const T>;
+
+    template<typename T>
+    constexpr auto label<const T> = ""sv;
+
+    constexpr auto insertion_sort_f = [](const auto first, const auto last) {
+        insertion_sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(insertion_sort_f)> = "Insertion sort"sv;
+
+    constexpr auto insertion_sort_byswap_f = [](const auto first,
+                                                const auto last) {
+        insertion_sort_byswap(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(insertion_sort_byswap_f)> =
+            "Insertion sort (swapping)"sv;
+
+    constexpr auto binary_insertion_sort_f = [](const auto first,
+                                                const auto last) {
+        binary_insertion_sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(binary_insertion_sort_f)> =
+            "Binary insertion sort"sv;
+
+    constexpr auto binary_insertion_sort_byrotate_f = [](const auto first,
+                                                         const auto last) {
+        binary_insertion_sort_byrotate(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(binary_insertion_sort_byrotate_f)> =
+            "Binary insertion sort (rotating)"sv;
+
+    constexpr auto merge_insertion_sort_f = [](const auto first,
+                                               const auto last) {
+        merge_insertion_sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(merge_insertion_sort_f)> =
+            "Merge-insertion sort (Ford-Johnson)"sv;
+
+    constexpr auto selection_sort_f = [](const auto first, const auto last) {
+        selection_sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(selection_sort_f)> = "Selection sort"sv;
+
+    constexpr auto bubble_sort_f = [](const auto first, const auto last) {
+        bubble_sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(bubble_sort_f)> = "Bubble sort (classic)"sv;
+
+    constexpr auto bubble_sort_nonadaptive_f = [](const auto first,
+                                                  const auto last) {
+        bubble_sort_nonadaptive(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(bubble_sort_nonadaptive_f)> =
+            "Bubble sort (non-adaptive)"sv;
+
+    constexpr auto bubble_sort_maxadaptive_f = [](const auto first,
+                                                  const auto last) {
+        bubble_sort_maxadaptive(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(bubble_sort_maxadaptive_f)> =
+            "Bubble sort (fully adaptive)"sv;
+
+    constexpr auto gnome_sort_f = [](const auto first, const auto last) {
+        gnome_sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(gnome_sort_f)> = "Gnome sort"sv;
+
+    constexpr auto shellsort_hibbard_f = [](const auto first, const auto last) {
+        shellsort_hibbard(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(shellsort_hibbard_f)> =
+            "Shellsort (Hibbard gap sequence)"sv;
+
+    constexpr auto shellsort_3smooth_f = [](const auto first, const auto last) {
+        shellsort_3smooth(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(shellsort_3smooth_f)> =
+            "Shellsort (3-smooth gap sequence)"sv;
+
+    constexpr auto shellsort_sedgewick_f = [](const auto first,
+                                              const auto last) {
+        shellsort_sedgewick(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(shellsort_sedgewick_f)> =
+            "Shellsort (Sedgewick gap sequence)"sv;
+
+    constexpr auto shellsort_tokuda_f = [](const auto first, const auto last) {
+        shellsort_tokuda(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(shellsort_tokuda_f)> =
+            "Shellsort (Tokuda gap sequence)"sv;
+
+    constexpr auto shellsort_quasi_ciura_f = [](const auto first,
+                                                const auto last) {
+        shellsort_quasi_ciura(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(shellsort_quasi_ciura_f)> =
+            "Shellsort (Extended Ciura gap sequence)"sv;
+
+    constexpr auto mergesort_topdown_f = [](const auto first, const auto last) {
+        mergesort_topdown(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(mergesort_topdown_f)> =
+            "Mergesort (top-down, recursive)"sv;
+
+    constexpr auto mergesort_halfbuffer_f = [](const auto first,
+                                               const auto last) {
+        mergesort_halfbuffer(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(mergesort_halfbuffer_f)> =
+            "Mergesort (top-down, recursive, half-size buffer)"sv;
+
+    // Runs mergesort_bounded with a buffer of Num/Den of the input length.
+    template<int Num, int Den>
+    constexpr auto mergesort_bounded_f = [](const auto first, const auto last) {
+        const auto len = std::distance(first, last);
+        using It = std::remove_const_t<decltype(first)>;
+        auto aux = detail::make_aux<It>(len / Den * Num
+                                        + len % Den * Num / Den);
+        mergesort_bounded(first, last, aux);
+    };
+
+    template<>
+    constexpr auto label<decltype(mergesort_bounded_f<0, 1>)> =
+            "Mergesort (bounded buffer, none)"sv;
+
+    template<>
+    constexpr auto label<decltype(mergesort_bounded_f<1, 64>)> =
+            "Mergesort (bounded buffer, 1/64 size)"sv;
+
+    template<>
+    constexpr auto label<decltype(mergesort_bounded_f<1, 8>)> =
+            "Mergesort (bounded buffer, 1/8 size)"sv;
+
+    template<>
+    constexpr auto label<decltype(mergesort_bounded_f<1, 2>)> =
+            "Mergesort (bounded buffer, 1/2 size)"sv;
+
+    template<>
+    constexpr auto label<decltype(mergesort_bounded_f<1, 1>)> =
+            "Mergesort (bounded buffer, full size)"sv;
+
+    constexpr auto mergesort_topdown_iterative_f = [](const auto first,
+                                                      const auto last) {
+        mergesort_topdown_iterative(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(mergesort_topdown_iterative_f)> =
+            "Mergesort (top-down, iterative)"sv;
+
+    constexpr auto mergesort_bottomup_iterative_f = [](const auto first,
+                                                       const auto last) {
+        mergesort_bottomup_iterative(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(mergesort_bottomup_iterative_f)> =
+            "Mergesort (bottom-up, iterative)"sv;
+
+    constexpr auto heapsort_f = [](const auto first, const auto last) {
+        heapsort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(heapsort_f)> = "Heapsort"sv;
+
+    constexpr auto heapsort_byswap_f = [](const auto first, const auto last) {
+        heapsort_byswap(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(heapsort_byswap_f)> = "Heapsort (swapping)"sv;
+
+    // The displacement bound ksorted_sort_f assumes, and that main's nearly
+    // sorted inputs are generated to obey.
+    constexpr auto displacement_bound = 16;
+
+    constexpr auto ksorted_sort_f = [](const auto first, const auto last) {
+        ksorted_sort(first, last, displacement_bound);
+    };
+
+    template<>
+    constexpr auto label<decltype(ksorted_sort_f)> =
+            "k-sorted sort (sliding minheap, k = 16)"sv;
+
+    constexpr auto quicksort_lomuto_simple_f = [](const auto first,
+                                                  const auto last) {
+        quicksort_lomuto_simple(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(quicksort_lomuto_simple_f)> =
+            "Quicksort "
+            "(Lomuto partitioning, middle-element pivot, recursive)"sv;
+
+    constexpr auto quicksort_lomuto_simple_iterative_f = [](const auto first,
+                                                            const auto last) {
+        quicksort_lomuto_simple_iterative(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(quicksort_lomuto_simple_iterative_f)> =
+            "Quicksort "
+            "(Lomuto partitioning, middle-element pivot, iterative)"sv;
+
+    constexpr auto quicksort_lomuto_f = [](const auto first, const auto last) {
+        quicksort_lomuto(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(quicksort_lomuto_f)> =
+            "Quicksort "
+            "(Lomuto partitioning, median-of-three pivot, recursive)"sv;
+
+    constexpr auto quicksort_lomuto_iterative_f = [](const auto first,
+                                                     const auto last) {
+        quicksort_lomuto_iterative(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(quicksort_lomuto_iterative_f)> =
+            "Quicksort "
+            "(Lomuto partitioning, median-of-three pivot, iterative)"sv;
+
+    constexpr auto quicksort_hoare_f = [](const auto first, const auto last) {
+        quicksort_hoare(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(quicksort_hoare_f)> =
+            "Quicksort "
+            "(Hoare partitioning, median-of-three pivot, recursive)"sv;
+
+    constexpr auto quicksort_hoare_iterative_f = [](const auto first,
+                                                    const auto last) {
+        quicksort_hoare_iterative(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(quicksort_hoare_iterative_f)> =
+            "Quicksort "
+            "(Hoare partitioning, median-of-three pivot, iterative)"sv;
+
+    constexpr auto quicksort_stable_f = [](const auto first, const auto last) {
+        quicksort_stable(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(quicksort_stable_f)> =
+            "Quicksort "
+            "(stable out-of-place three-way partitioning, recursive)"sv;
+
+    constexpr auto stdlib_heapsort_f = [](const auto first, const auto last) {
+        stdlib_heapsort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(stdlib_heapsort_f)> =
+            "std::make_heap + std::sort_heap (heapsort)"sv;
+
+    constexpr auto stdlib_mergesort_f = [](const auto first, const auto last) {
+        std::stable_sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(stdlib_mergesort_f)> =
+            "std::stable_sort (usually adaptive mergesort)"sv;
+
+    constexpr auto stdlib_introsort_f = [](const auto first, const auto last) {
+        std::sort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(stdlib_introsort_f)> =
+            "std::sort (usually introsort)"sv;
+
+    constexpr auto stdlib_qsort_f = [](const auto first, const auto last) {
+        stdlib_qsort(first, last);
+    };
+
+    template<>
+    constexpr auto label<decltype(stdlib_qsort_f)> =
+            "std::qsort (often quicksort)"sv;
+
+    // Order-preserving conversions from the int keys the distributions make
+    // to the element types the benchmark sorts, so each distribution of keys
+    // has the same shape in every type.
+    namespace element_types {
+        // The length of the prefix shared by all long strings, which makes
+        // their comparisons scan past it.
+        constexpr std::size_t long_string_prefix_length = 40;
+
+        // Renders a key as 8 hexadecimal digits that sort as the key does.
+        std::string ordered_hex(const int key)
+        {
+            constexpr auto digits = "0123456789abcdef"sv;
+
+            auto bits = static_cast<std::uint32_t>(key) ^ 0x8000'0000u;
+            std::string hex (8, '0');
+            for (auto p = rbegin(hex); p != rend(hex); ++p, bits >>= 4)
+                *p = digits[bits & 0xFu];
+            return hex;
+        }
+
+        // A trivially copyable record of Size bytes, ordered by its key.
+        template<std::size_t Size>
+        struct Record {
+            static_assert(Size > sizeof(int));
+
+            int key;
+            std::array<unsigned char, Size - sizeof(int)> payload;
+
+            friend bool operator<(const Record& lhs, const Record& rhs) noexcept
+            {
+                return lhs.key < rhs.key;
+            }
+
+            friend std::ostream& operator<<(std::ostream& out, const Record& r)
+            {
+                return out << r.key;
+            }
+        };
+
+        struct Int {
+            using Type = int;
+            static constexpr auto name = "int"sv;
+            static Type make(const int key) noexcept { return key; }
+        };
+
+        // Spreads keys over 64 bits, with low bits that depend on the key.
+        struct Int64 {
+            using Type = std::int64_t;
+            static constexpr auto name = "int64"sv;
+
+            static Type make(const int key) noexcept
+            {
+                const auto low = static_cast<std::uint32_t>(key) * 2654435761u;
+                return std::int64_t{key} * 0x1'0000'0000 + low;
+            }
+        };
+
+        struct UInt32 {
+            using Type = std::uint32_t;
+            static constexpr auto name = "uint32"sv;
+
+            static Type make(const int key) noexcept
+            {
+                return static_cast<std::uint32_t>(key) ^ 0x8000'0000u;
+            }
+        };
+
+        struct Double {
+            using Type = double;
+            static constexpr auto name = "double"sv;
+
+            static Type make(const int key) noexcept
+            {
+                return key / 1024.0; // exact, with a fractional part
+            }
+        };
+
+        // Strings short enough for the small-string optimization.
+        struct ShortString {
+            using Type = std::string;
+            static constexpr auto name = "string"sv;
+            static Type make(const int key) { return ordered_hex(key); }
+        };
+
+        // Heap-allocated strings that differ only after a long prefix.
+        struct LongString {
+            using Type = std::string;
+            static constexpr auto name = "long-string"sv;
+
+            static Type make(const int key)
+            {
+                return std::string(long_string_prefix_length, '.')
+                        + ordered_hex(key);
+            }
+        };
+
+        struct Pair {
+            using Type = std::pair<int, int>;
+            static constexpr auto name = "pair"sv;
+
+            static Type make(const int key) noexcept
+            {
+                return {key >> 8, key & 0xFF};
+            }
+        };
+
+        template<std::size_t Size>
+        struct Wide {
+            using Type = Record<Size>;
+            static constexpr auto name = (Size == 64 ? "record64"sv
+                                                     : "record256"sv);
+
+            static Type make(const int key) noexcept
+            {
+                Type record {key, {}};
+                record.payload.fill(static_cast<unsigned char>(key));
+                return record;
+            }
+        };
+    }
+
+    using AllElementTypes = std::tuple<element_types::Int,
+                                       element_types::Int64,
+                                       element_types::UInt32,
+                                       element_types::Double,
+                                       element_types::ShortString,
+                                       element_types::LongString,
+                                       element_types::Pair,
+                                       element_types::Wide<64>,
+                                       element_types::Wide<256>>;
+
+    template<typename E>
+    std::vector<typename E::Type> make_elements(const std::vector<int>& keys)
+    {
+        std::vector<typename E::Type> elems;
+        elems.reserve(size(keys));
+        for (const auto key : keys) elems.push_back(E::make(key));
+        return elems;
+    }
+
+    // Whether the algorithm F can sort elements of type T.
+    template<typename F, typename T>
+    constexpr auto supports_v = true;
+
+    template<typename T>
+    constexpr auto supports_v<std::remove_const_t<decltype(stdlib_qsort_f)>,
+                              T> = std::is_trivial_v<T>;
+
+    // Which algorithms are only run on small inputs.
+    enum class Group {
+        insertion,  // quadratic insertion sorts, skipped on large inputs
+        slowest,    // other quadratic sorts, also skipped with -S
+        fast,       // everything else, run on all inputs
+    };
+
+    constexpr std::string_view group_name(const Group group) noexcept
+    {
+        switch (group) {
+        case Group::insertion:
+            return "insertion"sv;
+        case Group::slowest:
+            return "slowest"sv;
+        case Group::fast:
+            return "fast"sv;
+        }
+
+        return ""sv;
+    }
+
+    // An algorithm's metadata, and its instantiation for elements of type T
+    // (or null, if it cannot sort them).
+    template<typename T>
+    struct Algorithm {
+        std::string_view name;
+        std::string_view label;
+        Group group;
+        bool stable;
+        void (*sort)(T*, T*);
+    };
+
+    template<typename T, const auto& f>
+    void sort_with(T* const first, T* const last)
+    {
+        f(first, last);
+    }
+
+    template<typename T, const auto& f>
+    constexpr Algorithm<T> make_algorithm(const std::string_view name,
+                                          const Group group, const bool stable)
+    {
+        using F = std::remove_const_t<std::remove_reference_t<decltype(f)>>;
+
+        void (*sort)(T*, T*) = nullptr;
+        if constexpr (supports_v<F, T>) sort = sort_with<T, f>;
+
+        return {name, label<F>, group, stable, sort};
+    }
+
+    // All the algorithms the benchmark knows, in the order it runs them.
+    template<typename T>
+    const std::vector<Algorithm<T>>& algorithms()
+    {
+        constexpr auto insertion = Group::insertion;
+        constexpr auto slowest = Group::slowest;
+        constexpr auto fast = Group::fast;
+
+        static const std::vector<Algorithm<T>> all {
+            make_algorithm<T, insertion_sort_f>(
+                    "insertion_sort"sv, insertion, true),
+            make_algorithm<T, insertion_sort_byswap_f>(
+                    "insertion_sort_byswap"sv, insertion, true),
+            make_algorithm<T, binary_insertion_sort_f>(
+                    "binary_insertion_sort"sv, insertion, true),
+            make_algorithm<T, binary_insertion_sort_byrotate_f>(
+                    "binary_insertion_sort_byrotate"sv, insertion, true),
+            make_algorithm<T, merge_insertion_sort_f>(
+                    "merge_insertion_sort"sv, insertion, false),
+            make_algorithm<T, selection_sort_f>(
+                    "selection_sort"sv, slowest, false),
+            make_algorithm<T, bubble_sort_f>(
+                    "bubble_sort"sv, slowest, true),
+            make_algorithm<T, bubble_sort_nonadaptive_f>(
+                    "bubble_sort_nonadaptive"sv, slowest, true),
+            make_algorithm<T, bubble_sort_maxadaptive_f>(
+                    "bubble_sort_maxadaptive"sv, slowest, true),
+            make_algorithm<T, gnome_sort_f>(
+                    "gnome_sort"sv, slowest, true),
+            make_algorithm<T, shellsort_hibbard_f>(
+                    "shellsort_hibbard"sv, fast, false),
+            make_algorithm<T, shellsort_3smooth_f>(
+                    "shellsort_3smooth"sv, fast, false),
+            make_algorithm<T, shellsort_sedgewick_f>(
+                    "shellsort_sedgewick"sv, fast, false),
+            make_algorithm<T, shellsort_tokuda_f>(
+                    "shellsort_tokuda"sv, fast, false),
+            make_algorithm<T, shellsort_quasi_ciura_f>(
+                    "shellsort_quasi_ciura"sv, fast, false),
+            make_algorithm<T, mergesort_topdown_f>(
+                    "mergesort_topdown"sv, fast, true),
+            make_algorithm<T, mergesort_halfbuffer_f>(
+                    "mergesort_halfbuffer"sv, fast, true),
+            make_algorithm<T, mergesort_bounded_f<0, 1>>(
+                    "mergesort_bounded_0"sv, fast, true),
+            make_algorithm<T, mergesort_bounded_f<1, 64>>(
+                    "mergesort_bounded_1_64"sv, fast, true),
+            make_algorithm<T, mergesort_bounded_f<1, 8>>(
+                    "mergesort_bounded_1_8"sv, fast, true),
+            make_algorithm<T, mergesort_bounded_f<1, 2>>(
+                    "mergesort_bounded_1_2"sv, fast, true),
+            make_algorithm<T, mergesort_bounded_f<1, 1>>(
+                    "mergesort_bounded_1"sv, fast, true),
+            make_algorithm<T, mergesort_topdown_iterative_f>(
+                    "mergesort_topdown_iterative"sv, fast, true),
+            make_algorithm<T, mergesort_bottomup_iterative_f>(
+                    "mergesort_bottomup_iterative"sv, fast, true),
+            make_algorithm<T, heapsort_f>(
+                    "heapsort"sv, fast, false),
+            make_algorithm<T, heapsort_byswap_f>(
+                    "heapsort_byswap"sv, fast, false),
+            make_algorithm<T, ksorted_sort_f>(
+                    "ksorted_sort"sv, fast, false),
+            make_algorithm<T, quicksort_lomuto_simple_f>(
+                    "quicksort_lomuto_simple"sv, fast, false),
+            make_algorithm<T, quicksort_lomuto_simple_iterative_f>(
+                    "quicksort_lomuto_simple_iterative"sv, fast, false),
+            make_algorithm<T, quicksort_lomuto_f>(
+                    "quicksort_lomuto"sv, fast, false),
+            make_algorithm<T, quicksort_lomuto_iterative_f>(
+                    "quicksort_lomuto_iterative"sv, fast, false),
+            make_algorithm<T, quicksort_hoare_f>(
+                    "quicksort_hoare"sv, fast, false),
+            make_algorithm<T, quicksort_hoare_iterative_f>(
+                    "quicksort_hoare_iterative"sv, fast, false),
+            make_algorithm<T, quicksort_stable_f>(
+                    "quicksort_stable"sv, fast, true),
+            make_algorithm<T, stdlib_heapsort_f>(
+                    "stdlib_heapsort"sv, fast, false),
+            make_algorithm<T, stdlib_mergesort_f>(
+                    "stdlib_mergesort"sv, fast, true),
+            make_algorithm<T, stdlib_introsort_f>(
+                    "stdlib_introsort"sv, fast, false),
+            make_algorithm<T, stdlib_qsort_f>(
+                    "stdlib_qsort"sv, fast, false),
+        };
+
+        return all;
+    }
+
+    // An element with its index in the input, compared by the element
+    // alone, so that a stable sort leaves equal elements in index order.
+    template<typename T>
+    struct Indexed {
+        T value;
+        std::size_t index;
+
+        friend bool operator<(const Indexed& lhs, const Indexed& rhs)
+        {
+            return lhs.value < rhs.value;
+        }
+    };
+
+    namespace distributions {
+        using Engine = std::mt19937;
+
+        // Makes an engine for one input, whose state depends only on the
+        // seed, the distribution's name, and the length, so the same seed
+        // reproduces the same inputs in any order and any build.
+        Engine make_engine(const std::uint64_t seed,
+                           const std::string_view dist_name,
+                           const std::size_t len)
+        {
+            auto name_hash = std::uint32_t{2166136261u}; // FNV-1a
+            for (const auto c : dist_name) {
+                name_hash ^= static_cast<unsigned char>(c);
+                name_hash *= 16777619u;
+            }
+
+            const auto wide_len = static_cast<std::uint64_t>(len);
+
+            std::seed_seq seq {static_cast<std::uint32_t>(seed),
+                               static_cast<std::uint32_t>(seed >> 32),
+                               name_hash,
+                               static_cast<std::uint32_t>(wide_len),
+                               static_cast<std::uint32_t>(wide_len >> 32)};
+
+            return Engine{seq};
+        }
+
+        // The number of runs in inputs made of concatenated sorted runs.
+        constexpr auto run_count = 16;
+
+        // The number of distinct values in inputs with few unique values.
+        constexpr auto unique_count = 16;
+
+        // Uniformly distributed values over the whole range of int.
+        std::vector<int> uniform(const std::size_t len, Engine& eng)
+        {
+            using Range = std::numeric_limits<int>;
+            std::uniform_int_distribution<int> dist {Range::min(),
+                                                     Range::max()};
+
+            std::vector<int> a (len);
+            for (auto& x : a) x = dist(eng);
+            return a;
+        }
+
+        std::vector<int> sorted(const std::size_t len, Engine& eng)
+        {
+            auto a = uniform(len, eng);
+            std::sort(begin(a), end(a));
+            return a;
+        }
+
+        std::vector<int> reversed(const std::size_t len, Engine& eng)
+        {
+            auto a = sorted(len, eng);
+            std::reverse(begin(a), end(a));
+            return a;
+        }
+
+        // Ascending, then descending.
+        std::vector<int> organ_pipe(const std::size_t len, Engine&)
+        {
+            std::vector<int> a (len);
+            for (std::size_t i = 0; i != len; ++i)
+                a[i] = static_cast<int>(std::min(i, len - 1 - i));
+            return a;
+        }
+
+        // Repeated ascending ramps, about sqrt(len) of them, each about as
+        // long as the number of them.
+        std::vector<int> sawtooth(const std::size_t len, Engine&)
+        {
+            const auto period = std::max(std::size_t{1}, static_cast<
+                    std::size_t>(std::sqrt(static_cast<double>(len))));
+
+            std::vector<int> a (len);
+            for (std::size_t i = 0; i != len; ++i)
+                a[i] = static_cast<int>(i % period);
+            return a;
+        }
+
+        std::vector<int> few_unique(const std::size_t len, Engine& eng)
+        {
+            std::uniform_int_distribution<int> dist {0, unique_count - 1};
+
+            std::vector<int> a (len);
+            for (auto& x : a) x = dist(eng);
+            return a;
+        }
+
+        std::vector<int> all_equal(const std::size_t len, Engine& eng)
+        {
+            return std::vector<int>(len, uniform(1, eng).front());
+        }
+
+        // Approximately Zipf-distributed (with exponent 1) ranks, in which the
+        // value k appears about 1/(k + 1) as often as 0. The ranks are drawn
+        // log-uniformly from [1, len + 1) and shifted down by one.
+        std::vector<int> zipf(const std::size_t len, Engine& eng)
+        {
+            const auto log_top = std::log(static_cast<double>(len) + 1.0);
+            std::uniform_real_distribution<double> dist {0.0, log_top};
+
+            std::vector<int> a (len);
+            for (auto& x : a)
+                x = static_cast<int>(std::floor(std::exp(dist(eng)))) - 1;
+            return a;
+        }
+
+        // Sorted, then with 3% as many random swaps as elements.
+        std::vector<int> nearly_sorted(const std::size_t len, Engine& eng)
+        {
+            auto a = sorted(len, eng);
+            if (len < 2) return a;
+
+            std::uniform_int_distribution<std::size_t> dist {0, len - 1};
+            for (auto swaps = len * 3 / 100; swaps != 0; --swaps)
+                std::swap(a[dist(eng)], a[dist(eng)]);
+            return a;
+        }
+
+        // Sorted perturbed so that no element is more than displacement_bound
+        // places from where it belongs. Shuffling within consecutive blocks
+        // of displacement_bound + 1 elements keeps each within its block.
+        std::vector<int> displaced(const std::size_t len, Engine& eng)
+        {
+            auto a = sorted(len, eng);
+
+            for (auto first = begin(a); first != end(a); ) {
+                const auto last = first + std::min(
+                        std::ptrdiff_t{displacement_bound + 1}, end(a) - first);
+                std::shuffle(first, last, eng);
+                first = last;
+            }
+
+            return a;
+        }
+
+        // Concatenated independently sorted runs of random values.
+        std::vector<int> runs(const std::size_t len, Engine& eng)
+        {
+            auto a = uniform(len, eng);
+
+            for (std::size_t i = 0; i != run_count; ++i) {
+                std::sort(begin(a) + static_cast<std::ptrdiff_t>(
+                                        len * i / run_count),
+                          begin(a) + static_cast<std::ptrdiff_t>(
+                                        len * (i + 1) / run_count));
+            }
+
+            return a;
+        }
+
+        // Random, except that the last tenth is sorted.
+        std::vector<int> sorted_tail(const std::size_t len, Engine& eng)
+        {
+            auto a = uniform(len, eng);
+            std::sort(end(a) - static_cast<std::ptrdiff_t>(len / 10), end(a));
+            return a;
+        }
+
+        // Musser's median-of-3 killer ("Introspective Sorting and Selection
+        // Algorithms", 1997): with k = len / 2, the first half holds 1, k + 1,
+        // 3, k + 3, ..., and the second half 2, 4, ..., 2k, so that picking
+        // the median of the first, middle, and last elements keeps choosing
+        // one of the smallest. That is a permutation only if k is even, so
+        // the pattern is built with k rounded down to even, and the one to
+        // three elements left over are the largest ones, in order, at the end.
+        std::vector<int> median_of_three_killer(const std::size_t len, Engine&)
+        {
+            const auto k = len / 2 / 2 * 2;
+
+            std::vector<int> a (len);
+            for (std::size_t i = 1; i <= k; ++i) {
+                a[i - 1] = static_cast<int>(i % 2 != 0 ? i : k + i - 1);
+                a[k + i - 1] = static_cast<int>(2 * i);
+            }
+            for (auto i = 2 * k; i != len; ++i) a[i] = static_cast<int>(i + 1);
+
+            assert([&a] {
+                auto sorted = a;
+                std::sort(begin(sorted), end(sorted));
+                for (std::size_t i = 0; i != size(sorted); ++i)
+                    if (sorted[i] != static_cast<int>(i + 1)) return false;
+                return true;
+            }());
+
+            return a;
+        }
+    }
+
+    // A named way to generate benchmark inputs of any length. The antiqsort
+    // inputs have no generator, as each is built against one algorithm.
+    struct Distribution {
+        std::string_view name;
+        std::vector<int> (*generate)(std::size_t, distributions::Engine&);
+    };
+
+    constexpr std::array all_distributions {
+        Distribution{"random"sv, distributions::uniform},
+        Distribution{"sorted"sv, distributions::sorted},
+        Distribution{"reversed"sv, distributions::reversed},
+        Distribution{"organ-pipe"sv, distributions::organ_pipe},
+        Distribution{"sawtooth"sv, distributions::sawtooth},
+        Distribution{"few-unique"sv, distributions::few_unique},
+        Distribution{"all-equal"sv, distributions::all_equal},
+        Distribution{"zipf"sv, distributions::zipf},
+        Distribution{"nearly-sorted"sv, distributions::nearly_sorted},
+        Distribution{"displaced"sv, distributions::displaced},
+        Distribution{"runs"sv, distributions::runs},
+        Distribution{"sorted-tail"sv, distributions::sorted_tail},
+        Distribution{"median-of-3-killer"sv,
+                     distributions::median_of_three_killer},
+        Distribution{"antiqsort"sv, nullptr},
+    };
+
+    // Calls f with a default-constructed object of each element type.
+    template<typename F>
+    void for_each_element_type(const F f)
+    {
+        std::apply([f](const auto... es) { (..., f(es)); }, AllElementTypes{});
+    }
+}
+
+#endif // !SORTS_H